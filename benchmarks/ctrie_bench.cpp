@@ -0,0 +1,791 @@
+/// @file ctrie_bench.cpp
+/// @brief Microbenchmarks for the CTrie, with standard containers as baselines.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+///
+/// Usage: ctrie_bench [--keys=N] [--ops=N] [--threads=N] [--seed=N] [--output=FILE]
+///
+/// The results are printed as a single JSON document, either on the standard
+/// output or in the given file, so that they can be tracked across revisions.
+
+#include "ctrie/ctrie.hpp"
+#include "ctrie/sharded_ctrie.hpp"
+#include "ctrie/static_ctrie.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// Allocation tracking.
+// ============================================================================
+
+/// Bytes currently allocated through the global operator new.
+static std::atomic<long long> liveBytes(0);
+
+/// Header placed in front of each allocation to remember its size.
+static const std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+// Keep the replacements out of line, otherwise GCC inlines them into the
+// standard containers and reports the header arithmetic as out of bounds.
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void *operator new(std::size_t size)
+{
+    auto *raw = static_cast<char *>(std::malloc(size + HEADER_SIZE));
+    if (raw == nullptr) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<std::size_t *>(raw) = size;
+    liveBytes += static_cast<long long>(size);
+    return raw + HEADER_SIZE;
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+BENCH_NOINLINE void operator delete(void *ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    auto *raw = static_cast<char *>(ptr) - HEADER_SIZE;
+    liveBytes -= static_cast<long long>(*reinterpret_cast<std::size_t *>(raw));
+    std::free(raw);
+}
+
+void operator delete[](void *ptr) noexcept { operator delete(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { operator delete(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { operator delete(ptr); }
+
+// ============================================================================
+// Configuration and datasets.
+// ============================================================================
+
+/// @brief The benchmark configuration.
+struct Config {
+    /// Number of keys per dataset.
+    std::size_t keys = 20000;
+    /// Number of operations per thread in the scaling benchmark.
+    std::size_t ops = 200000;
+    /// Maximum number of threads in the scaling benchmark.
+    std::size_t threads = 0;
+    /// Seed of the random generator.
+    unsigned seed = 42;
+    /// Output file, empty for the standard output.
+    std::string output;
+};
+
+/// @brief A named set of keys.
+struct Dataset {
+    /// The name of the dataset.
+    std::string name;
+    /// The keys, without duplicates.
+    std::vector<std::string> keys;
+};
+
+/// @brief Remove duplicates while keeping the generation order.
+/// @param keys The keys to filter.
+/// @return The unique keys.
+static auto uniqueKeys(const std::vector<std::string> &keys) -> std::vector<std::string>
+{
+    std::vector<std::string> result;
+    result.reserve(keys.size());
+    std::unordered_map<std::string, bool> seen;
+    for (const auto &key : keys) {
+        if (!seen[key]) {
+            seen[key] = true;
+            result.push_back(key);
+        }
+    }
+    return result;
+}
+
+/// @brief Generate random alphanumeric strings of 8 to 24 characters.
+static auto makeRandom(std::size_t count, std::mt19937_64 &rng) -> Dataset
+{
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    std::uniform_int_distribution<std::size_t> length(8, 24);
+    std::uniform_int_distribution<std::size_t> symbol(0, sizeof(alphabet) - 2);
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string key(length(rng), ' ');
+        for (auto &c : key) {
+            c = alphabet[symbol(rng)];
+        }
+        keys.push_back(key);
+    }
+    return Dataset{"random", uniqueKeys(keys)};
+}
+
+/// @brief Generate URL-like keys sharing long, dense prefixes.
+static auto makeUrls(std::size_t count, std::mt19937_64 &rng) -> Dataset
+{
+    static const char *resources[] = {"users", "orders", "invoices", "devices", "sessions"};
+    std::uniform_int_distribution<unsigned> tenant(0, 63);
+    std::uniform_int_distribution<unsigned> resource(0, 4);
+    std::uniform_int_distribution<unsigned> id(0, 999999);
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::ostringstream ss;
+        ss << "/api/v2/tenants/" << tenant(rng) << "/" << resources[resource(rng)] << "/" << id(rng);
+        keys.push_back(ss.str());
+    }
+    return Dataset{"urls", uniqueKeys(keys)};
+}
+
+/// @brief Generate long keys (256 characters) that differ only in their tail.
+static auto makeLong(std::size_t count, std::mt19937_64 &rng) -> Dataset
+{
+    std::uniform_int_distribution<unsigned> symbol('a', 'z');
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string key(256, 'k');
+        for (std::size_t j = 224; j < key.size(); ++j) {
+            key[j] = static_cast<char>(symbol(rng));
+        }
+        keys.push_back(key);
+    }
+    return Dataset{"long", uniqueKeys(keys)};
+}
+
+/// @brief Generate decimal representations of random 64-bit integers.
+static auto makeIntegers(std::size_t count, std::mt19937_64 &rng) -> Dataset
+{
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < count; ++i) {
+        keys.push_back(std::to_string(rng()));
+    }
+    return Dataset{"integers", uniqueKeys(keys)};
+}
+
+// ============================================================================
+// Containers under test.
+// ============================================================================
+
+/// @brief Adapter for the CTrie.
+struct CTrieAdapter {
+    static auto name() -> const char * { return "ctrie"; }
+    ctrie::CTrie<std::size_t> trie;
+    void insert(const std::string &key, std::size_t value) { trie.insert(key, value); }
+    auto find(const std::string &key, std::size_t &value) -> bool { return trie.find(key, value); }
+    auto remove(const std::string &key) -> bool { return trie.remove(key); }
+};
+
+/// @brief Adapter for std::map.
+struct MapAdapter {
+    static auto name() -> const char * { return "std::map"; }
+    std::map<std::string, std::size_t> map;
+    void insert(const std::string &key, std::size_t value) { map[key] = value; }
+    auto find(const std::string &key, std::size_t &value) -> bool
+    {
+        auto it = map.find(key);
+        if (it == map.end()) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+    auto remove(const std::string &key) -> bool { return map.erase(key) > 0; }
+};
+
+/// @brief Adapter for std::unordered_map.
+struct UnorderedMapAdapter {
+    static auto name() -> const char * { return "std::unordered_map"; }
+    std::unordered_map<std::string, std::size_t> map;
+    void insert(const std::string &key, std::size_t value) { map[key] = value; }
+    auto find(const std::string &key, std::size_t &value) -> bool
+    {
+        auto it = map.find(key);
+        if (it == map.end()) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+    auto remove(const std::string &key) -> bool { return map.erase(key) > 0; }
+};
+
+/// @brief Adapter for a sorted vector of pairs.
+struct SortedVectorAdapter {
+    static auto name() -> const char * { return "sorted_vector"; }
+    using entry_t = std::pair<std::string, std::size_t>;
+    std::vector<entry_t> data;
+    static auto less(const entry_t &lhs, const std::string &rhs) -> bool { return lhs.first < rhs; }
+    void insert(const std::string &key, std::size_t value)
+    {
+        auto it = std::lower_bound(data.begin(), data.end(), key, less);
+        if (it != data.end() && it->first == key) {
+            it->second = value;
+        } else {
+            data.insert(it, entry_t(key, value));
+        }
+    }
+    auto find(const std::string &key, std::size_t &value) -> bool
+    {
+        auto it = std::lower_bound(data.begin(), data.end(), key, less);
+        if (it == data.end() || it->first != key) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+    auto remove(const std::string &key) -> bool
+    {
+        auto it = std::lower_bound(data.begin(), data.end(), key, less);
+        if (it == data.end() || it->first != key) {
+            return false;
+        }
+        data.erase(it);
+        return true;
+    }
+};
+
+// ============================================================================
+// Measurements.
+// ============================================================================
+
+using bench_clock = std::chrono::steady_clock;
+
+/// Accumulates found values so that lookups cannot be optimized away.
+static volatile std::size_t sink = 0;
+
+/// @brief Summary of the latencies of a single phase.
+struct Summary {
+    double opsPerSecond = 0.0;
+    double p50 = 0.0, p90 = 0.0, p99 = 0.0, p999 = 0.0, max = 0.0;
+};
+
+/// @brief Run an operation once per key, for throughput and then for latency.
+/// @details The throughput pass only reads the clock around the whole loop,
+/// the latency pass times each call. Operations changing the container need
+/// a reset, called between the passes, that restores the initial state.
+/// @param keys The keys to visit.
+/// @param op The operation to perform.
+/// @param reset Restores the state of the container before the second pass.
+/// @return The throughput and latency percentiles (in ns).
+template <typename Operation, typename Reset>
+static auto measure(const std::vector<std::string> &keys, Operation op, Reset reset) -> Summary
+{
+    Summary summary;
+    if (keys.empty()) {
+        return summary;
+    }
+    auto begin = bench_clock::now();
+    for (const auto &key : keys) {
+        op(key);
+    }
+    auto elapsed = std::chrono::duration<double>(bench_clock::now() - begin).count();
+    reset();
+    std::vector<double> samples;
+    samples.reserve(keys.size());
+    for (const auto &key : keys) {
+        auto start = bench_clock::now();
+        op(key);
+        samples.push_back(std::chrono::duration<double, std::nano>(bench_clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<std::size_t>(q * static_cast<double>(samples.size())))];
+    };
+    summary.opsPerSecond = static_cast<double>(samples.size()) / elapsed;
+    summary.p50          = at(0.50);
+    summary.p90          = at(0.90);
+    summary.p99          = at(0.99);
+    summary.p999         = at(0.999);
+    summary.max          = samples.back();
+    return summary;
+}
+
+/// @brief Run a lookup once per key, for throughput and then for latency.
+template <typename Operation>
+static auto measure(const std::vector<std::string> &keys, Operation op) -> Summary
+{
+    return measure(keys, op, [] {});
+}
+
+/// @brief Print a summary as a JSON object.
+static void printSummary(std::ostream &os, const Summary &s)
+{
+    os << "{\"ops_per_second\": " << s.opsPerSecond << ", \"latency_ns\": {\"p50\": " << s.p50
+       << ", \"p90\": " << s.p90 << ", \"p99\": " << s.p99 << ", \"p999\": " << s.p999 << ", \"max\": " << s.max
+       << "}}";
+}
+
+/// @brief Benchmark insert, find (hits and misses) and remove on a container.
+template <typename Adapter>
+static void benchSingle(std::ostream &os, const Dataset &dataset, std::mt19937_64 &rng)
+{
+    std::vector<std::string> order(dataset.keys);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<std::string> misses;
+    for (const auto &key : order) {
+        misses.push_back(key + "#");
+    }
+
+    auto before    = liveBytes.load();
+    auto *instance = new Adapter();
+    std::size_t counter = 0;
+    auto fill = [&] {
+        for (const auto &key : order) {
+            instance->insert(key, counter++);
+        }
+    };
+
+    // Inserting again needs an empty container.
+    auto insert = measure(order, [&](const std::string &key) { instance->insert(key, counter++); }, [&] {
+        delete instance;
+        instance = new Adapter();
+    });
+    auto bytes = static_cast<double>(liveBytes.load() - before);
+    std::shuffle(order.begin(), order.end(), rng);
+    auto findHit = measure(order, [&](const std::string &key) {
+        std::size_t value = 0;
+        if (instance->find(key, value)) {
+            sink = sink + value;
+        }
+    });
+    auto findMiss = measure(misses, [&](const std::string &key) {
+        std::size_t value = 0;
+        if (instance->find(key, value)) {
+            sink = sink + value;
+        }
+    });
+    std::shuffle(order.begin(), order.end(), rng);
+    auto remove = measure(order, [&](const std::string &key) { instance->remove(key); }, fill);
+    delete instance;
+
+    os << "    {\"dataset\": \"" << dataset.name << "\", \"container\": \"" << Adapter::name()
+       << "\", \"keys\": " << dataset.keys.size()
+       << ", \"bytes_per_key\": " << bytes / static_cast<double>(dataset.keys.size()) << ",\n";
+    os << "     \"insert\": ";
+    printSummary(os, insert);
+    os << ",\n     \"find_hit\": ";
+    printSummary(os, findHit);
+    os << ",\n     \"find_miss\": ";
+    printSummary(os, findMiss);
+    os << ",\n     \"remove\": ";
+    printSummary(os, remove);
+    os << "}";
+}
+
+/// @brief Give the calling worker its own home shard, for Affinity routing.
+template <typename Trie>
+static void bindWorker(Trie &, std::size_t)
+{
+    // Only sharded tries have home shards.
+}
+
+/// @brief Give the calling worker its own home shard, for Affinity routing.
+template <typename T>
+static void bindWorker(ctrie::ShardedCTrie<T> &, std::size_t worker)
+{
+    ctrie::ShardedCTrie<T>::bindThread(worker);
+}
+
+/// @brief Run a read/write mix on a shared trie with the given number of threads.
+/// @details Each worker loads its share of the keys before the clock starts,
+/// so that with Affinity routing every shard is filled by its own worker.
+/// @return The aggregated throughput in operations per second.
+template <typename Trie>
+static auto benchScaling(
+    Trie &trie,
+    const Dataset &dataset,
+    std::size_t threads,
+    unsigned writePercent,
+    std::size_t ops,
+    unsigned seed) -> double
+{
+    std::atomic<std::size_t> ready(0);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            bindWorker(trie, t);
+            for (std::size_t i = t; i < dataset.keys.size(); i += threads) {
+                trie.insert(dataset.keys[i], i);
+            }
+            std::mt19937_64 local(seed + t);
+            std::uniform_int_distribution<std::size_t> pick(0, dataset.keys.size() - 1);
+            std::uniform_int_distribution<unsigned> percent(0, 99);
+            ++ready;
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            std::size_t value = 0;
+            for (std::size_t i = 0; i < ops; ++i) {
+                const auto &key = dataset.keys[pick(local)];
+                if (percent(local) < writePercent) {
+                    trie.insert(key, i);
+                } else if (trie.find(key, value)) {
+                    sink = sink + value;
+                }
+            }
+        });
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    auto begin = bench_clock::now();
+    start.store(true);
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    auto elapsed = std::chrono::duration<double>(bench_clock::now() - begin).count();
+    return static_cast<double>(threads * ops) / elapsed;
+}
+
+/// @brief Load and then drop all the keys of a dataset, in batches of the given size.
+/// @param batchSize The number of operations per batch, 1 for single operations.
+/// @return The throughput in operations per second.
+static auto benchBatches(const Dataset &dataset, std::size_t batchSize, std::mt19937_64 &rng) -> double
+{
+    std::vector<std::string> order(dataset.keys);
+    std::shuffle(order.begin(), order.end(), rng);
+    ctrie::CTrie<std::size_t> trie;
+    auto begin = bench_clock::now();
+    if (batchSize == 1) {
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            trie.insert(order[i], i);
+        }
+        for (const auto &key : order) {
+            trie.remove(key);
+        }
+    } else {
+        ctrie::WriteBatch<std::size_t> batch;
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            batch.insert(order[i], i);
+            if (batch.size() == batchSize || i + 1 == order.size()) {
+                trie.apply(batch);
+                batch.clear();
+            }
+        }
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            batch.remove(order[i]);
+            if (batch.size() == batchSize || i + 1 == order.size()) {
+                trie.apply(batch);
+                batch.clear();
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(bench_clock::now() - begin).count();
+    return static_cast<double>(2 * order.size()) / elapsed;
+}
+
+/// @brief Benchmark lookups and removals on a trie with the prefix index set to the given stride.
+/// @param stride The stride of the index, zero to disable it.
+static void benchPrefixIndex(std::ostream &os, const Dataset &dataset, std::size_t stride, std::mt19937_64 &rng)
+{
+    std::vector<std::string> order(dataset.keys);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<std::string> misses;
+    for (const auto &key : order) {
+        misses.push_back(key + "#");
+    }
+    ctrie::CTrie<std::size_t> trie;
+    trie.setPrefixIndex(stride);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        trie.insert(order[i], i);
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    auto lookup = [&](const std::string &key) {
+        std::size_t value = 0;
+        if (trie.find(key, value)) {
+            sink = sink + value;
+        }
+    };
+    auto findHit  = measure(order, lookup);
+    auto findMiss = measure(misses, lookup);
+    auto bytes     = trie.stats().bytes;
+    std::shuffle(order.begin(), order.end(), rng);
+    auto remove = measure(order, [&](const std::string &key) { trie.remove(key); }, [&] {
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            trie.insert(order[i], i);
+        }
+    });
+    os << "    {\"dataset\": \"" << dataset.name << "\", \"stride\": " << stride
+       << ", \"bytes_per_key\": " << static_cast<double>(bytes) / static_cast<double>(order.size())
+       << ",\n     \"find_hit\": ";
+    printSummary(os, findHit);
+    os << ",\n     \"find_miss\": ";
+    printSummary(os, findMiss);
+    os << ",\n     \"remove\": ";
+    printSummary(os, remove);
+    os << "}";
+}
+
+// ============================================================================
+// Keyword matching.
+// ============================================================================
+
+/// HTTP methods and header names, as matched by a protocol parser.
+static constexpr std::pair<std::string_view, int> keywords[] = {
+    {"GET", 0}, {"HEAD", 1}, {"POST", 2}, {"PUT", 3}, {"DELETE", 4}, {"CONNECT", 5}, {"OPTIONS", 6},
+    {"TRACE", 7}, {"PATCH", 8}, {"Accept", 9}, {"Accept-Charset", 10}, {"Accept-Encoding", 11},
+    {"Accept-Language", 12}, {"Authorization", 13}, {"Cache-Control", 14}, {"Connection", 15},
+    {"Content-Encoding", 16}, {"Content-Length", 17}, {"Content-Type", 18}, {"Cookie", 19}, {"Date", 20},
+    {"ETag", 21}, {"Expect", 22}, {"Expires", 23}, {"From", 24}, {"Host", 25}, {"If-Match", 26},
+    {"If-Modified-Since", 27}, {"If-None-Match", 28}, {"If-Range", 29}, {"Last-Modified", 30}, {"Location", 31},
+    {"Origin", 32}, {"Pragma", 33}, {"Range", 34}, {"Referer", 35}, {"Server", 36}, {"Set-Cookie", 37},
+    {"Transfer-Encoding", 38}, {"Upgrade", 39}, {"User-Agent", 40}, {"Vary", 41}, {"Via", 42},
+};
+
+/// The number of slots of the perfect hash, sparse enough to find a seed quickly.
+static constexpr std::size_t HASH_SLOTS = 512;
+
+/// @brief Seeded FNV-1a.
+static constexpr auto keywordHash(std::string_view key, std::uint32_t seed) -> std::uint32_t
+{
+    std::uint32_t h = 2166136261U ^ seed;
+    for (char c : key) {
+        h = (h ^ static_cast<unsigned char>(c)) * 16777619U;
+    }
+    return h;
+}
+
+/// @brief Find the first seed giving a perfect hash of the keywords.
+static constexpr auto findSeed() -> std::uint32_t
+{
+    for (std::uint32_t seed = 0;; ++seed) {
+        std::array<bool, HASH_SLOTS> used{};
+        bool collision = false;
+        for (const auto &entry : keywords) {
+            auto slot  = keywordHash(entry.first, seed) % HASH_SLOTS;
+            collision  = collision || used[slot];
+            used[slot] = true;
+        }
+        if (!collision) {
+            return seed;
+        }
+    }
+}
+
+/// The collision-free seed, found at compile time.
+static constexpr std::uint32_t HASH_SEED = findSeed();
+
+/// @brief Build the slots of the perfect hash, each holding a keyword index or -1.
+static constexpr auto buildSlots() -> std::array<int, HASH_SLOTS>
+{
+    std::array<int, HASH_SLOTS> result{};
+    for (auto &slot : result) {
+        slot = -1;
+    }
+    for (std::size_t i = 0; i < std::size(keywords); ++i) {
+        result[keywordHash(keywords[i].first, HASH_SEED) % HASH_SLOTS] = static_cast<int>(i);
+    }
+    return result;
+}
+
+/// The slots of the perfect hash.
+static constexpr std::array<int, HASH_SLOTS> HASH_TABLE = buildSlots();
+
+/// @brief Find the value of a keyword with the perfect hash.
+static auto perfectHashFind(std::string_view key, int &value) -> bool
+{
+    auto index = HASH_TABLE[keywordHash(key, HASH_SEED) % HASH_SLOTS];
+    if (index < 0 || keywords[index].first != key) {
+        return false;
+    }
+    value = keywords[index].second;
+    return true;
+}
+
+/// @brief Match a stream of tokens against the keywords with each method.
+static void benchKeywords(std::ostream &os, const Config &config, std::mt19937_64 &rng)
+{
+    // Three tokens out of four are keywords, the others are near misses.
+    std::vector<std::string> tokens;
+    std::uniform_int_distribution<std::size_t> pick(0, std::size(keywords) - 1);
+    std::uniform_int_distribution<unsigned> miss(0, 3);
+    for (std::size_t i = 0; i < config.ops; ++i) {
+        std::string token(keywords[pick(rng)].first);
+        if (miss(rng) == 0) {
+            token.back() = '_';
+        }
+        tokens.push_back(token);
+    }
+
+    static constexpr ctrie::StaticCTrie<keywords> staticTrie;
+    ctrie::CTrie<int> runtimeTrie;
+    std::unordered_map<std::string_view, int> unordered;
+    for (const auto &entry : keywords) {
+        runtimeTrie.insert(std::string(entry.first), entry.second);
+        unordered.emplace(entry.first, entry.second);
+    }
+
+    auto run = [&tokens](const char *name, const std::function<bool(const std::string &, int &)> &find) {
+        std::size_t found = 0;
+        auto begin        = bench_clock::now();
+        for (const auto &token : tokens) {
+            int value = 0;
+            if (find(token, value)) {
+                sink = sink + static_cast<std::size_t>(value);
+                ++found;
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+        std::ostringstream ss;
+        ss << "    {\"container\": \"" << name << "\", \"tokens\": " << tokens.size() << ", \"found\": " << found
+           << ", \"ns_per_token\": " << elapsed / static_cast<double>(tokens.size()) << "}";
+        return ss.str();
+    };
+    os << "  \"keywords\": [\n";
+    os << run("static_ctrie", [](const std::string &key, int &value) { return staticTrie.find(key, value); })
+       << ",\n";
+    os << run("ctrie", [&runtimeTrie](const std::string &key, int &value) { return runtimeTrie.find(key, value); })
+       << ",\n";
+    os << run("perfect_hash", [](const std::string &key, int &value) { return perfectHashFind(key, value); })
+       << ",\n";
+    os << run("std::unordered_map", [&unordered](const std::string &key, int &value) {
+        auto it = unordered.find(key);
+        if (it == unordered.end()) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }) << "\n";
+    os << "  ],\n";
+}
+
+/// @brief Parse the command line.
+static auto parse(int argc, char *argv[]) -> Config
+{
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        auto eq = arg.find('=');
+        auto name  = arg.substr(0, eq);
+        auto value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+        if (name == "--keys") {
+            config.keys = static_cast<std::size_t>(std::stoull(value));
+        } else if (name == "--ops") {
+            config.ops = static_cast<std::size_t>(std::stoull(value));
+        } else if (name == "--threads") {
+            config.threads = static_cast<std::size_t>(std::stoull(value));
+        } else if (name == "--seed") {
+            config.seed = static_cast<unsigned>(std::stoul(value));
+        } else if (name == "--output") {
+            config.output = value;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--keys=N] [--ops=N] [--threads=N] [--seed=N] [--output=FILE]\n";
+            std::exit(1);
+        }
+    }
+    if (config.threads == 0) {
+        config.threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    return config;
+}
+
+int main(int argc, char *argv[])
+{
+    auto config = parse(argc, argv);
+    std::mt19937_64 rng(config.seed);
+
+    std::vector<Dataset> datasets;
+    datasets.push_back(makeRandom(config.keys, rng));
+    datasets.push_back(makeUrls(config.keys, rng));
+    datasets.push_back(makeLong(config.keys, rng));
+    datasets.push_back(makeIntegers(config.keys, rng));
+
+    std::ostringstream os;
+    os << "{\n  \"config\": {\"keys\": " << config.keys << ", \"ops\": " << config.ops
+       << ", \"threads\": " << config.threads << ", \"seed\": " << config.seed << "},\n";
+
+    os << "  \"single_thread\": [\n";
+    for (std::size_t i = 0; i < datasets.size(); ++i) {
+        benchSingle<CTrieAdapter>(os, datasets[i], rng);
+        os << ",\n";
+        benchSingle<MapAdapter>(os, datasets[i], rng);
+        os << ",\n";
+        benchSingle<UnorderedMapAdapter>(os, datasets[i], rng);
+        os << ",\n";
+        benchSingle<SortedVectorAdapter>(os, datasets[i], rng);
+        os << (i + 1 < datasets.size() ? ",\n" : "\n");
+    }
+    os << "  ],\n";
+
+    os << "  \"batches\": [\n";
+    const std::size_t batchSizes[] = {1, 16, 256, 4096};
+    for (std::size_t i = 0; i < datasets.size(); ++i) {
+        for (auto batchSize : batchSizes) {
+            os << "    {\"dataset\": \"" << datasets[i].name << "\", \"batch_size\": " << batchSize
+               << ", \"ops_per_second\": " << benchBatches(datasets[i], batchSize, rng) << "}";
+            os << (i + 1 < datasets.size() || batchSize != batchSizes[3] ? ",\n" : "\n");
+        }
+    }
+    os << "  ],\n";
+
+    // The datasets whose keys share long prefixes.
+    os << "  \"prefix_index\": [\n";
+    const std::size_t strides[] = {0, 8, 16};
+    for (auto stride : strides) {
+        benchPrefixIndex(os, datasets[1], stride, rng);
+        os << ",\n";
+    }
+    for (auto stride : strides) {
+        benchPrefixIndex(os, datasets[2], stride, rng);
+        os << (stride != strides[2] ? ",\n" : "\n");
+    }
+    os << "  ],\n";
+
+    benchKeywords(os, config, rng);
+
+    os << "  \"scaling\": [\n";
+    const unsigned mixes[] = {0, 10, 50};
+    // Powers of two, always ending with the requested number of threads.
+    std::vector<std::size_t> threadCounts;
+    for (std::size_t threads = 1; threads < config.threads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(config.threads);
+    bool first = true;
+    for (auto threads : threadCounts) {
+        for (auto writePercent : mixes) {
+            // A single trie, against one shard per hardware thread.
+            ctrie::CTrie<std::size_t> single;
+            ctrie::ShardedCTrie<std::size_t> hashed(config.threads, ctrie::ShardRouting::Hash);
+            ctrie::ShardedCTrie<std::size_t> affine(config.threads, ctrie::ShardRouting::Affinity);
+            const std::pair<const char *, double> results[] = {
+                {"ctrie", benchScaling(single, datasets[1], threads, writePercent, config.ops, config.seed)},
+                {"sharded_ctrie", benchScaling(hashed, datasets[1], threads, writePercent, config.ops, config.seed)},
+                {"sharded_ctrie_affinity",
+                 benchScaling(affine, datasets[1], threads, writePercent, config.ops, config.seed)},
+            };
+            for (const auto &result : results) {
+                os << (first ? "" : ",\n") << "    {\"dataset\": \"" << datasets[1].name << "\", \"container\": \""
+                   << result.first << "\", \"threads\": " << threads << ", \"write_percent\": " << writePercent
+                   << ", \"ops_per_second\": " << result.second << "}";
+                first = false;
+            }
+        }
+    }
+    os << "\n  ]\n}\n";
+
+    if (config.output.empty()) {
+        std::cout << os.str();
+    } else {
+        std::ofstream file(config.output);
+        file << os.str();
+    }
+    return 0;
+}
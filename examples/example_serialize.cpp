@@ -10,5 +10,9 @@ int main()
     std::string serialized = trie.toString();
     std::cout << "Serialized Trie: " << serialized << std::endl;
 
+    // Machine-readable dump, one "key<TAB>value" line per entry.
+    std::cout << "Dump:\n";
+    trie.dump(std::cout);
+
     return 0;
 }
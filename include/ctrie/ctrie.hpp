@@ -5,15 +5,26 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #if __cplusplus >= 201103L
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <thread>
 #endif
 
+
 enum : unsigned char {
     CTRIE_MAJOR_VERSION = 1, ///< Major version of the library.
     CTRIE_MINOR_VERSION = 0, ///< Minor version of the library.
@@ -38,6 +49,8 @@ public:
     /// @param _value The value to store.
     explicit SNode(const T &_value)
         : value(_value)
+        , referenced(false)
+        , expiry(std::chrono::steady_clock::time_point::max())
     {
         // Nothing to do.
     }
@@ -71,9 +84,40 @@ public:
     /// @return The value of the node.
     auto getValue() const -> T { return value; }
 
+    /// @brief Mark the value as recently used.
+    /// @details The bit is only written when it is not already set, so that
+    /// frequent lookups do not keep dirtying the cache line.
+    void touch()
+    {
+        if (!referenced.load(std::memory_order_relaxed)) {
+            referenced.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief Clear the recently used mark.
+    /// @return true if the value was marked as recently used.
+    auto clearReferenced() -> bool { return referenced.exchange(false, std::memory_order_relaxed); }
+
+    /// @brief Set the time after which the value is expired.
+    /// @param _expiry The expiry time, time_point::max() for no expiry.
+    void setExpiry(std::chrono::steady_clock::time_point _expiry) { expiry = _expiry; }
+
+    /// @brief Check if the value has an expiry time.
+    /// @return true if the value can expire.
+    auto hasExpiry() const -> bool { return expiry != std::chrono::steady_clock::time_point::max(); }
+
+    /// @brief Check if the value is expired.
+    /// @param now The current time.
+    /// @return true if the value is expired.
+    auto isExpired(std::chrono::steady_clock::time_point now) const -> bool { return expiry <= now; }
+
 private:
     /// The stored value.
     T value;
+    /// The CLOCK reference bit, set by lookups.
+    std::atomic<bool> referenced;
+    /// The time after which the value is expired.
+    std::chrono::steady_clock::time_point expiry;
 };
 
 /// @brief A node of the prefix tree.
@@ -124,8 +168,22 @@ public:
     /// @return Reference to the instance.
     auto operator=(CNode &&other) noexcept -> CNode & = delete;
 
-    /// @brief Destruct the node.
-    virtual ~CNode() = default;
+    /// @brief Destruct the node and its subtree.
+    /// @details The subtree is unlinked iteratively: letting each child destroy
+    /// its own children would nest one destructor call per key character.
+    virtual ~CNode()
+    {
+        std::vector<std::shared_ptr<CNode<T>>> pending;
+        this->releaseChildren(pending);
+        while (!pending.empty()) {
+            auto node = std::move(pending.back());
+            pending.pop_back();
+            // Only take apart nodes that are not shared with someone else.
+            if (node.use_count() == 1) {
+                node->releaseChildren(pending);
+            }
+        }
+    }
 
     /// @brief Get the key of the node.
     /// @return The key of the node.
@@ -205,6 +263,18 @@ public:
         return children[index];
     }
 
+    /// @brief Move all the children of the node into the given vector.
+    /// @param out The vector receiving the children.
+    void releaseChildren(std::vector<std::shared_ptr<CNode<T>>> &out)
+    {
+        for (auto &child : children) {
+            if (child) {
+                out.push_back(std::move(child));
+                child.reset();
+            }
+        }
+    }
+
     /// @brief Check if the node has children.
     /// @return true if the node has children, false otherwise.
     auto hasChildren() const -> bool
@@ -217,6 +287,62 @@ public:
         return false;
     }
 
+    /// @brief Count the number of non-empty children.
+    /// @return The number of children of the node.
+    auto countChildren() const -> std::size_t
+    {
+        std::size_t count = 0;
+        for (const auto &child : children) {
+            if (child) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    /// @brief Write the tree rooted at this node to the given stream.
+    /// @details The tree is visited iteratively, so the stack usage does not
+    /// depend on the length of the keys, and each line is streamed directly.
+    /// @param os The output stream.
+    /// @param prefix The prefix to prepend to each line of the output.
+    /// @param isLast Whether this node is the last child in a sequence.
+    void print(std::ostream &os, const std::string &prefix = "", bool isLast = true) const
+    {
+        // The prefix grows and shrinks as we move down and up the tree.
+        std::string linePrefix(prefix);
+        // Print the current node with its prefix, except for the root.
+        if (parent.lock()) {
+            os << linePrefix << (isLast ? "└─" : "├─");
+        }
+        this->printValue(os);
+        linePrefix += (isLast ? "  " : "│ ");
+        // Each frame keeps the next child to visit and the prefix length to restore.
+        struct Frame {
+            const CNode<T> *node;
+            std::size_t next;
+            std::size_t prefixLength;
+        };
+        std::vector<Frame> stack;
+        stack.push_back(Frame{this, this->nextChild(0), linePrefix.size()});
+        while (!stack.empty()) {
+            auto &frame = stack.back();
+            if (frame.next >= MAX_KEYS) {
+                stack.pop_back();
+                continue;
+            }
+            const CNode<T> *child = frame.node->children[frame.next].get();
+            // Look ahead once, so that we know if this is the last child.
+            frame.next       = frame.node->nextChild(frame.next + 1);
+            bool isLastChild = frame.next >= MAX_KEYS;
+            // Restore the prefix of the level we are printing.
+            linePrefix.resize(frame.prefixLength);
+            os << linePrefix << (isLastChild ? "└─" : "├─");
+            child->printValue(os);
+            linePrefix += (isLastChild ? "  " : "│ ");
+            stack.push_back(Frame{child, child->nextChild(0), linePrefix.size()});
+        }
+    }
+
     /// @brief Get the string representation of the node.
     /// @param prefix The prefix to prepend to each line of the output.
     /// @param isLast Whether this node is the last child in a sequence.
@@ -224,43 +350,68 @@ public:
     auto toString(const std::string &prefix = "", bool isLast = true) const -> std::string
     {
         std::stringstream ss;
-        // Print the current node with its prefix, except for the root.
-        if (parent.lock()) {
-            ss << prefix;
-            ss << (isLast ? "└─" : "├─");
-        }
-        ss << key;
-        if (snode) {
-            ss << " : " << snode->getValue();
+        this->print(ss, prefix, isLast);
+        return ss.str();
+    }
+
+    /// @brief Visit, in key order, all the values stored below this node.
+    /// @details Expired values are skipped.
+    /// @param _key The key of this node, used as the prefix of the visited keys.
+    /// @param visitor Called with the full key and the value of each entry.
+    template <typename Visitor>
+    void visit(const std::string &_key, Visitor visitor) const
+    {
+        auto now  = std::chrono::steady_clock::now();
+        auto live = [&now](const std::shared_ptr<SNode<T>> &value) {
+            return value && !(value->hasExpiry() && value->isExpired(now));
+        };
+        // The key grows and shrinks as we move down and up the tree.
+        std::string path(_key);
+        std::vector<std::pair<const CNode<T> *, std::size_t>> stack;
+        if (live(snode)) {
+            visitor(path, snode->getValue());
         }
-        ss << "\n";
-        // Compute the new prefix for children.
-        std::string childPrefix = prefix + (isLast ? "  " : "│ ");
-        // Iterate over children.
-        for (std::size_t i = 0; i < children.size(); ++i) {
-            if (children[i]) {
-                // Determine if this child is the last one.
-                ss << children[i]->toString(childPrefix, this->isLastChild(i));
+        stack.emplace_back(this, this->nextChild(0));
+        while (!stack.empty()) {
+            auto &frame = stack.back();
+            if (frame.second >= MAX_KEYS) {
+                stack.pop_back();
+                if (!stack.empty()) {
+                    path.pop_back();
+                }
+                continue;
             }
+            const CNode<T> *child = frame.first->children[frame.second].get();
+            frame.second          = frame.first->nextChild(frame.second + 1);
+            path.push_back(child->key);
+            if (live(child->snode)) {
+                visitor(path, child->snode->getValue());
+            }
+            stack.emplace_back(child, child->nextChild(0));
         }
-        return ss.str();
     }
 
 private:
-    /// @brief Checks if there are more children after the given index.
-    /// @param index The index to check.
-    /// @return true if there are no children after the given index, false otherwise.
-    auto isLastChild(std::size_t index) const -> bool
-    {
-        // Iterate through the children starting from the next index.
-        for (std::size_t i = index + 1; i < children.size(); ++i) {
-            // If a child exists at any position after the given index, return false.
-            if (children[i]) {
-                return false;
-            }
+    /// @brief Find the first child at or after the given index.
+    /// @param index The index to start from.
+    /// @return The index of the child, or MAX_KEYS if there is none.
+    auto nextChild(std::size_t index) const -> std::size_t
+    {
+        while (index < children.size() && !children[index]) {
+            ++index;
         }
-        // No children found after the given index, return true.
-        return true;
+        return index;
+    }
+
+    /// @brief Write the key and the value of this node, followed by a newline.
+    /// @param os The output stream.
+    void printValue(std::ostream &os) const
+    {
+        os << key;
+        if (snode) {
+            os << " : " << snode->getValue();
+        }
+        os << "\n";
     }
 
     /// A pointer to the parent.
@@ -273,6 +424,391 @@ private:
     std::array<std::shared_ptr<CNode<T>>, MAX_KEYS> children;
 };
 
+#if __cplusplus >= 201103L
+/// @brief Background thread that destroys retired trees.
+/// @details Tries handing their old tree to a reclaimer return immediately,
+/// while the actual deallocation happens on the reclaimer thread.
+class Reclaimer
+{
+public:
+    /// @brief Construct a new reclaimer and start its thread.
+    Reclaimer()
+        : mutex()
+        , condition()
+        , queue()
+        , destroying(false)
+        , stopping(false)
+        , worker(&Reclaimer::run, this)
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The instance to copy from.
+    Reclaimer(const Reclaimer &other) = delete;
+
+    /// @brief Copy assignment operator.
+    /// @param other The instance to copy from.
+    /// @return Reference to the instance.
+    auto operator=(const Reclaimer &other) -> Reclaimer & = delete;
+
+    /// @brief Move constructor.
+    /// @param other The instance to move from.
+    Reclaimer(Reclaimer &&other) = delete;
+
+    /// @brief Move assignment operator.
+    /// @param other The instance to move from.
+    /// @return Reference to the instance.
+    auto operator=(Reclaimer &&other) -> Reclaimer & = delete;
+
+    /// @brief Destroy everything still queued and stop the thread.
+    ~Reclaimer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_one();
+        worker.join();
+    }
+
+    /// @brief Hand an object over to the reclaimer thread.
+    /// @param garbage The object to destroy, the caller should hold no other reference.
+    void retire(std::shared_ptr<void> garbage)
+    {
+        if (!garbage) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(garbage));
+        }
+        condition.notify_one();
+    }
+
+    /// @brief Get the number of objects not yet destroyed.
+    /// @return The number of queued objects, plus the one being destroyed, if any.
+    auto pending() const -> std::size_t
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size() + (destroying ? 1 : 0);
+    }
+
+private:
+    /// @brief The body of the reclaimer thread.
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                // Only reached when stopping.
+                return;
+            }
+            auto garbage = std::move(queue.front());
+            queue.pop_front();
+            destroying = true;
+            // Destroy the object without holding the lock.
+            lock.unlock();
+            garbage.reset();
+            lock.lock();
+            destroying = false;
+        }
+    }
+
+    /// Protects the queue and the flags.
+    mutable std::mutex mutex;
+    /// Signals new objects or the request to stop.
+    std::condition_variable condition;
+    /// The objects waiting to be destroyed.
+    std::deque<std::shared_ptr<void>> queue;
+    /// Whether an object taken off the queue is being destroyed.
+    bool destroying;
+    /// Whether the reclaimer is shutting down.
+    bool stopping;
+    /// The reclaimer thread, started last.
+    std::thread worker;
+};
+#endif
+
+/// @brief Structural and runtime statistics of a trie.
+struct CTrieStats {
+    /// @brief The number of fan-out classes tracked in nodesByFanOut.
+    static const std::size_t FAN_OUT_CLASSES = 5;
+
+    /// The number of stored keys.
+    std::size_t keys = 0;
+    /// The number of nodes, including the root.
+    std::size_t nodes = 0;
+    /// The number of nodes per fan-out class: 0, 1, 2-4, 5-16 and 17+ children.
+    std::array<std::size_t, FAN_OUT_CLASSES> nodesByFanOut = {};
+    /// Estimated heap bytes used by nodes and values (excluding memory owned by T).
+    std::size_t bytes = 0;
+    /// The average depth of the stored keys.
+    double averageDepth = 0.0;
+    /// The maximum depth of the stored keys.
+    std::size_t maxDepth = 0;
+    /// The ratio of empty slots over all the slots of the children arrays.
+    double emptySlotRatio = 0.0;
+
+    /// Number of times the internal mutex was acquired (instrumentation only).
+    std::uint64_t lockAcquisitions = 0;
+    /// Total time spent waiting for the internal mutex, in ns (instrumentation only).
+    std::uint64_t lockWaitNanoseconds = 0;
+    /// Number of lookups performed (instrumentation only).
+    std::uint64_t lookups = 0;
+    /// Total number of nodes visited by lookups (instrumentation only).
+    std::uint64_t lookupPathLength = 0;
+    /// Longest path visited by a single lookup (instrumentation only).
+    std::uint64_t maxLookupPathLength = 0;
+    /// Number of node and value allocations (instrumentation only).
+    std::uint64_t allocations = 0;
+
+    /// Number of entries evicted to respect the cache budget (cache mode only).
+    std::uint64_t evictions = 0;
+    /// Number of expired entries removed (cache mode only).
+    std::uint64_t expirations = 0;
+
+    /// @brief Get the fan-out class of a node with the given number of children.
+    /// @param children The number of children.
+    /// @return The index inside nodesByFanOut.
+    static auto fanOutClass(std::size_t children) -> std::size_t
+    {
+        if (children <= 1) {
+            return children;
+        }
+        if (children <= 4) {
+            return 2;
+        }
+        if (children <= 16) {
+            return 3;
+        }
+        return 4;
+    }
+};
+
+#ifdef CTRIE_ENABLE_INSTRUMENTATION
+namespace detail
+{
+
+/// @brief Per-thread runtime counters, written only by their owning thread.
+struct CounterBlock {
+    /// Number of times the internal mutex was acquired.
+    std::atomic<std::uint64_t> lockAcquisitions{0};
+    /// Total time spent waiting for the internal mutex, in ns.
+    std::atomic<std::uint64_t> lockWaitNanoseconds{0};
+    /// Number of lookups performed.
+    std::atomic<std::uint64_t> lookups{0};
+    /// Total number of nodes visited by lookups.
+    std::atomic<std::uint64_t> lookupPathLength{0};
+    /// Longest path visited by a single lookup.
+    std::atomic<std::uint64_t> maxLookupPathLength{0};
+    /// Number of node and value allocations.
+    std::atomic<std::uint64_t> allocations{0};
+
+    /// @brief Add to a counter owned by the calling thread.
+    /// @param counter The counter to update.
+    /// @param amount The amount to add.
+    static void add(std::atomic<std::uint64_t> &counter, std::uint64_t amount)
+    {
+        // Single writer: a plain load/store avoids a locked read-modify-write.
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    /// @brief Raise a counter owned by the calling thread to the given value.
+    /// @param counter The counter to update.
+    /// @param value The candidate maximum.
+    static void max(std::atomic<std::uint64_t> &counter, std::uint64_t value)
+    {
+        if (value > counter.load(std::memory_order_relaxed)) {
+            counter.store(value, std::memory_order_relaxed);
+        }
+    }
+};
+
+/// @brief Registry of the per-thread counters of a single trie.
+class CounterRegistry
+{
+public:
+    /// @brief Construct a new registry with a process-unique identifier.
+    CounterRegistry()
+        : id(nextId())
+        , mutex()
+        , blocks()
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Get the counters of the calling thread, creating them if needed.
+    /// @return The counters of the calling thread.
+    auto local() -> CounterBlock &
+    {
+        // A per-thread map keeps the common path free of locks, whatever the
+        // number of tries used by the thread.
+        static thread_local LocalBlocks cache;
+        auto it = cache.blocks.find(id);
+        if (it != cache.blocks.end()) {
+            return *it->second;
+        }
+        std::shared_ptr<CounterBlock> block;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto owner = std::this_thread::get_id();
+            auto found = std::find_if(
+                blocks.begin(), blocks.end(),
+                [&owner](const std::pair<std::thread::id, std::shared_ptr<CounterBlock>> &b) {
+                    return b.first == owner;
+                });
+            if (found == blocks.end()) {
+                found = blocks.insert(blocks.end(), std::make_pair(owner, std::make_shared<CounterBlock>()));
+            }
+            block = found->second;
+        }
+        cache.prune();
+        return *cache.blocks.emplace(id, std::move(block)).first->second;
+    }
+
+    /// @brief Sum the counters of all threads into the given statistics.
+    /// @param stats The statistics to fill.
+    void aggregate(CTrieStats &stats) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto &entry : blocks) {
+            const auto &block = entry.second;
+            stats.lockAcquisitions += block->lockAcquisitions.load(std::memory_order_relaxed);
+            stats.lockWaitNanoseconds += block->lockWaitNanoseconds.load(std::memory_order_relaxed);
+            stats.lookups += block->lookups.load(std::memory_order_relaxed);
+            stats.lookupPathLength += block->lookupPathLength.load(std::memory_order_relaxed);
+            stats.maxLookupPathLength =
+                std::max(stats.maxLookupPathLength, block->maxLookupPathLength.load(std::memory_order_relaxed));
+            stats.allocations += block->allocations.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    /// @brief The counters of the calling thread, for every registry it used.
+    struct LocalBlocks {
+        /// The counters, by registry identifier.
+        std::unordered_map<std::uint64_t, std::shared_ptr<CounterBlock>> blocks;
+        /// The size above which the counters of destroyed registries are dropped.
+        std::size_t limit = 64;
+
+        /// @brief Drop the counters of destroyed registries, once the map has grown.
+        void prune()
+        {
+            if (blocks.size() < limit) {
+                return;
+            }
+            for (auto it = blocks.begin(); it != blocks.end();) {
+                // Only this map still references the counters of a destroyed registry.
+                it = it->second.use_count() == 1 ? blocks.erase(it) : std::next(it);
+            }
+            limit = std::max<std::size_t>(64, 2 * blocks.size());
+        }
+    };
+
+    /// @brief Generate a new process-unique identifier (zero is reserved).
+    /// @return The identifier.
+    static auto nextId() -> std::uint64_t
+    {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
+    /// The identifier of the registry.
+    std::uint64_t id;
+    /// Protects the list of blocks.
+    mutable std::mutex mutex;
+    /// The counters of every thread that used the trie.
+    std::vector<std::pair<std::thread::id, std::shared_ptr<CounterBlock>>> blocks;
+};
+
+} // namespace detail
+#endif
+
+/// @brief The limits of a trie used as a cache.
+struct CachePolicy {
+    /// Maximum number of entries, zero for no limit.
+    std::size_t maxEntries = 0;
+    /// Maximum estimated bytes (see CTrieStats::bytes), zero for no limit.
+    std::size_t maxBytes = 0;
+    /// Time to live of the entries inserted without an explicit one, zero for none.
+    std::chrono::steady_clock::duration defaultTtl = std::chrono::steady_clock::duration::zero();
+    /// Number of entries checked for expiry by each insertion.
+    std::size_t expiryBudget = 8;
+};
+
+template <typename T>
+class CTrie;
+
+/// @brief A group of insertions and removals, applied atomically by CTrie::apply().
+/// @details Operations on the same key take effect in the order they were
+/// added, so the last one wins.
+template <typename T>
+class WriteBatch
+{
+public:
+    /// @brief Queue the insertion of a key-value pair.
+    /// @param key The key to insert.
+    /// @param value The value associated with the key.
+    /// @return true if the operation was queued, false if the key is empty.
+    auto insert(const std::string &key, T value) -> bool
+    {
+        if (key.empty()) {
+            return false;
+        }
+        operations.push_back(Operation{key, values.size()});
+        values.push_back(std::move(value));
+        return true;
+    }
+
+    /// @brief Queue the removal of a key.
+    /// @param key The key to remove.
+    /// @return true if the operation was queued, false if the key is empty.
+    auto remove(const std::string &key) -> bool
+    {
+        if (key.empty()) {
+            return false;
+        }
+        operations.push_back(Operation{key, REMOVAL});
+        return true;
+    }
+
+    /// @brief Get the number of queued operations.
+    /// @return The number of operations.
+    auto size() const -> std::size_t { return operations.size(); }
+
+    /// @brief Check if there are no queued operations.
+    /// @return true if the batch is empty, false otherwise.
+    auto empty() const -> bool { return operations.empty(); }
+
+    /// @brief Drop all the queued operations.
+    void clear()
+    {
+        operations.clear();
+        values.clear();
+    }
+
+private:
+    friend class CTrie<T>;
+
+    /// @brief Marks an operation that removes its key.
+    static constexpr std::size_t REMOVAL = static_cast<std::size_t>(-1);
+
+    /// @brief A queued operation.
+    struct Operation {
+        /// The key of the operation.
+        std::string key;
+        /// The index of the value to insert, or REMOVAL.
+        std::size_t value;
+    };
+
+    /// The operations, in the order they were added.
+    std::vector<Operation> operations;
+    /// The values of the insertions.
+    std::vector<T> values;
+};
+
 /// @brief A prefix tree.
 template <typename T>
 class CTrie
@@ -282,7 +818,11 @@ public:
     CTrie() = default;
 
     /// @brief Destroy the CTrie object.
-    virtual ~CTrie() { _root.reset(); }
+    /// @details The tree is handed to the reclaimer, if one is set.
+    virtual ~CTrie()
+    {
+        this->dispose(std::move(_root), std::move(_index));
+    }
 
     /// @brief Copy constructor.
     CTrie(const CTrie &other) = delete;
@@ -291,12 +831,63 @@ public:
     auto operator=(const CTrie &other) -> CTrie & = delete;
 
     /// @brief Move constructor.
-    CTrie(CTrie &&other) noexcept = delete;
+    /// @details Takes over the tree and the reclaimer of other, which is left
+    /// empty. Runtime instrumentation counters are not transferred.
+    /// @param other The instance to move from.
+    CTrie(CTrie &&other) noexcept
+        : CTrie()
+    {
+#if __cplusplus >= 201103L
+        // Automatically lock and unlock the mutex of the other trie.
+        auto lock = other.acquire();
+        _reclaimer.swap(other._reclaimer);
+#endif
+        _root.swap(other._root);
+        std::swap(_size, other._size);
+        std::swap(_nodes, other._nodes);
+        std::swap(_cache, other._cache);
+        std::swap(_index, other._index);
+    }
 
     /// @brief Move assignment operator.
-    auto operator=(CTrie &&other) noexcept -> CTrie & = delete;
+    /// @details Takes over the tree of other, but keeps the reclaimer of this
+    /// trie: the previous tree is destroyed like by clear(), so repeated
+    /// reloads of a serving trie all go through its reclaimer.
+    /// @param other The instance to move from.
+    /// @return Reference to the instance.
+    auto operator=(CTrie &&other) noexcept -> CTrie &
+    {
+        if (this == &other) {
+            return *this;
+        }
+        std::shared_ptr<CNode<T>> old;
+        PrefixIndex oldIndex;
+        {
+#if __cplusplus >= 201103L
+            // Lock both tries without risking a deadlock with a concurrent reverse move.
+            std::unique_lock<std::mutex> lock(_mutex, std::defer_lock);
+            std::unique_lock<std::mutex> otherLock(other._mutex, std::defer_lock);
+            std::lock(lock, otherLock);
+#endif
+            old.swap(_root);
+            std::swap(oldIndex, _index);
+            _root.swap(other._root);
+            _size        = other._size;
+            _nodes       = other._nodes;
+            _cache       = std::move(other._cache);
+            _index       = std::move(other._index);
+            other._size  = 0;
+            other._nodes = 0;
+            other._cache = CacheState();
+            other._index = PrefixIndex();
+        }
+        this->dispose(std::move(old), std::move(oldIndex));
+        return *this;
+    }
 
     /// @brief Inserts the key-value pair into the Trie.
+    /// @details In cache mode the entry expires after the default time to live
+    /// of the policy, and the insertion may evict other entries.
     /// @param key The key to insert.
     /// @param value The value associated with the key.
     /// @return true if the insertion was successful, false otherwise.
@@ -308,27 +899,31 @@ public:
         }
 #if __cplusplus >= 201103L
         // Automatically lock the mutex for thread safety.
-        std::lock_guard<std::mutex> lock(_mutex);
+        auto lock = this->acquire();
 #endif
-        // Initialize the root node if it doesn't exist.
-        if (!_root) {
-            _root = std::make_shared<CNode<T>>(nullptr, 0);
-        }
-        // Start from the root node.
-        auto node = _root;
-        // Traverse the Trie, creating child nodes if they don't exist.
-        for (const auto &ch : key) {
-            auto child = node->at(ch);
-            // Create a new child node if the current character doesn't exist.
-            if (!child) {
-                child = std::make_shared<CNode<T>>(node, ch);
-                node->insertChild(ch, child);
-            }
-            // Move to the next child node.
-            node = child;
+        this->insertUnlocked(key, value, _cache.enabled ? _cache.policy.defaultTtl : ttl_t::zero());
+        // Return true indicating successful insertion.
+        return true;
+    }
+
+    /// @brief Inserts the key-value pair into the Trie, with a time to live.
+    /// @details Expired entries are never found. They are reclaimed
+    /// incrementally in cache mode, and only by remove() otherwise.
+    /// @param key The key to insert.
+    /// @param value The value associated with the key.
+    /// @param ttl The time to live of the entry, zero for no expiry.
+    /// @return true if the insertion was successful, false otherwise.
+    auto insert(const std::string &key, T value, std::chrono::steady_clock::duration ttl) -> bool
+    {
+        // Return false if the key is empty.
+        if (key.empty()) {
+            return false;
         }
-        // Set the value at the final node.
-        node->setSNode(value);
+#if __cplusplus >= 201103L
+        // Automatically lock the mutex for thread safety.
+        auto lock = this->acquire();
+#endif
+        this->insertUnlocked(key, value, ttl);
         // Return true indicating successful insertion.
         return true;
     }
@@ -337,31 +932,65 @@ public:
     /// @param key the key to use for the search.
     /// @param value the output variable where the found value is stored.
     /// @return true if we have found the value, false otherwise.
+    /// @throws std::out_of_range if the key holds a character out of bounds.
     auto find(const std::string &key, T &value) const -> bool
     {
-        // Return false if the key is empty or there's no root node.
-        if (key.empty() || !_root) {
+        // Return false if the key is empty.
+        if (key.empty()) {
             return false;
         }
+        // Check the whole key, the prefix index may skip some of its characters.
+        checkKey(key, "find: key out of bounds");
 #if __cplusplus >= 201103L
         // Automatically lock and unlock the mutex.
-        std::lock_guard<std::mutex> lock(_mutex);
+        auto lock = this->acquire();
 #endif
+        // The root is replaced by clear() and by moves, so check it under the lock.
+        if (!_root) {
+            return false;
+        }
 
         // Start from the root node.
         auto node = _root;
-        // Traverse the trie using each character in the key.
-        for (char ch : key) {
+#ifdef CTRIE_ENABLE_INSTRUMENTATION
+        // Record the path length when leaving the lookup, whatever the outcome.
+        struct PathRecorder {
+            detail::CounterBlock &block;
+            std::uint64_t length;
+            ~PathRecorder()
+            {
+                detail::CounterBlock::add(block.lookups, 1);
+                detail::CounterBlock::add(block.lookupPathLength, length);
+                detail::CounterBlock::max(block.maxLookupPathLength, length);
+            }
+        } recorder{_counters.local(), 0};
+#endif
+        // Skip the upper levels through the prefix index, if enabled.
+        auto depth = this->jumpUnlocked(key, node);
+        if (!node) {
+            // Key path doesn't exist.
+            return false;
+        }
+#ifdef CTRIE_ENABLE_INSTRUMENTATION
+        recorder.length = depth > 0 ? 1 : 0;
+#endif
+        // Traverse the trie using the rest of the key.
+        for (; depth < key.size(); ++depth) {
             // Move to the corresponding child node.
-            node = node->at(ch);
+            node = node->at(key[depth]);
             if (!node) {
                 // Key path doesn't exist.
                 return false;
             }
+#ifdef CTRIE_ENABLE_INSTRUMENTATION
+            ++recorder.length;
+#endif
         }
-        // If the node holds a value, assign it and return true.
-        if (node->getSNode()) {
-            value = node->getSNode()->getValue();
+        // If the node holds a live value, assign it and return true.
+        const auto &snode = node->getSNode();
+        if (snode && !(snode->hasExpiry() && snode->isExpired(std::chrono::steady_clock::now()))) {
+            snode->touch();
+            value = snode->getValue();
             return true;
         }
         // Key exists, but no associated value found.
@@ -371,43 +1000,38 @@ public:
     /// @brief Removes the key-value pair from the Trie.
     /// @param key The key to remove.
     /// @return true if the removal was successful, false otherwise.
+    /// @throws std::out_of_range if the key holds a character out of bounds.
     auto remove(const std::string &key) -> bool
     {
-        // Return false if the key is empty or there's no root node.
-        if (key.empty() || !_root) {
+        // Return false if the key is empty.
+        if (key.empty()) {
             return false;
         }
+        // Check the whole key, the prefix index may skip some of its characters.
+        checkKey(key, "remove: key out of bounds");
 #if __cplusplus >= 201103L
         // Automatically lock and unlock the mutex.
-        std::lock_guard<std::mutex> lock(_mutex);
+        auto lock = this->acquire();
 #endif
+        // The root is replaced by clear() and by moves, so check it under the lock.
+        if (!_root) {
+            return false;
+        }
 
-        // Start from the root node.
-        auto node = _root;
+        // Start from the root node, or from the deepest indexed one.
+        auto node  = _root;
+        auto depth = this->jumpUnlocked(key, node);
         // Traverse the Trie to find the node corresponding to the key.
-        for (char ch : key) {
-            node = node->at(ch);
-            if (!node) {
-                // Key path doesn't exist.
-                return false;
-            }
+        for (; node && depth < key.size(); ++depth) {
+            node = node->at(key[depth]);
         }
-        // If the node has an associated value, remove it.
+        if (!node) {
+            // Key path doesn't exist.
+            return false;
+        }
+        // If the node has an associated value, remove it.
         if (node->getSNode()) {
-            // Clear the stored value.
-            node->clearSNode();
-            // Remove nodes up the parent chain if they meet removal conditions.
-            while (node) {
-                auto parent = node->getParent();
-                if (!node->hasChildren() && parent && !node->getSNode()) {
-                    parent->removeChild(node->getKey());
-                    // Move to the parent node.
-                    node = parent;
-                } else {
-                    // Stop if the current node shouldn't be removed.
-                    break;
-                }
-            }
+            this->eraseUnlocked(node, &key);
             // Key successfully removed.
             return true;
         }
@@ -415,25 +1039,915 @@ public:
         return false;
     }
 
+    /// @brief Apply all the operations of a batch under a single lock acquisition.
+    /// @details Readers observe either none or all of the batch. The operations
+    /// are sorted by key, so that each walk resumes from the prefix it shares
+    /// with the previous key instead of starting again from the root. In cache
+    /// mode, expiry and eviction run once, after the whole batch.
+    /// @param batch The operations to apply.
+    /// @return The number of operations that changed the trie.
+    /// @throws std::out_of_range if a key holds a character out of bounds, in
+    /// which case the trie is left untouched.
+    auto apply(const WriteBatch<T> &batch) -> std::size_t
+    {
+        using operation_t = typename WriteBatch<T>::Operation;
+        if (batch.empty()) {
+            return 0;
+        }
+        // Sort before taking the lock, operations on the same key keep their order.
+        std::vector<const operation_t *> order;
+        order.reserve(batch.operations.size());
+        for (const auto &operation : batch.operations) {
+            // Reject the whole batch up front rather than failing half way.
+            checkKey(operation.key, "apply: key out of bounds");
+            order.push_back(&operation);
+        }
+        std::stable_sort(order.begin(), order.end(), [](const operation_t *lhs, const operation_t *rhs) {
+            return lhs->key < rhs->key;
+        });
+#if __cplusplus >= 201103L
+        // Automatically lock and unlock the mutex.
+        auto lock = this->acquire();
+#endif
+        const auto ttl            = _cache.enabled ? _cache.policy.defaultTtl : ttl_t::zero();
+        std::uint64_t allocations = 0;
+        std::size_t changed       = 0;
+        // The nodes spelling a prefix of the previous key, starting from the root.
+        std::vector<std::shared_ptr<CNode<T>>> path;
+        const std::string *previous = nullptr;
+        for (const auto *operation : order) {
+            const auto &key    = operation->key;
+            const bool removal = operation->value == WriteBatch<T>::REMOVAL;
+            if (path.empty()) {
+                if (!_root) {
+                    if (removal) {
+                        continue;
+                    }
+                    _root = std::make_shared<CNode<T>>(nullptr, 0);
+                    ++allocations;
+                    ++_nodes;
+                }
+                path.push_back(_root);
+            }
+            // Keep the part of the path shared with the previous key.
+            std::size_t depth = 0;
+            if (previous) {
+                const auto limit = std::min(path.size() - 1, key.size());
+                while (depth < limit && (*previous)[depth] == key[depth]) {
+                    ++depth;
+                }
+            }
+            path.resize(depth + 1);
+            previous = &key;
+            // Walk down the rest of the key, creating the nodes of insertions.
+            while (path.size() <= key.size()) {
+                const auto ch = key[path.size() - 1];
+                auto child    = path.back()->at(ch);
+                if (!child) {
+                    if (removal) {
+                        break;
+                    }
+                    child = std::make_shared<CNode<T>>(path.back(), ch);
+                    path.back()->insertChild(ch, child);
+                    this->indexUnlocked(key, path.size(), child);
+                    ++allocations;
+                    ++_nodes;
+                }
+                path.push_back(std::move(child));
+            }
+            if (!removal) {
+                allocations += this->storeUnlocked(path.back(), batch.values[operation->value], ttl);
+                ++changed;
+            } else if (path.size() > key.size() && path.back()->getSNode()) {
+                // Forget the pruned nodes, the root is never pruned.
+                path.resize(path.size() - this->eraseUnlocked(path.back(), &key));
+                ++changed;
+            }
+        }
+#ifdef CTRIE_ENABLE_INSTRUMENTATION
+        detail::CounterBlock::add(_counters.local().allocations, allocations);
+#endif
+        if (_cache.enabled) {
+            this->maintainCache();
+        }
+        return changed;
+    }
+
+    /// @brief Get the number of entries, including expired ones not yet reclaimed.
+    /// @return The number of entries.
+    auto size() const -> std::size_t
+    {
+#if __cplusplus >= 201103L
+        // Automatically lock and unlock the mutex.
+        auto lock = this->acquire();
+#endif
+        return _size;
+    }
+
+    /// @brief Turn the trie into a bounded cache, or change its limits.
+    /// @details Entries are tracked on a CLOCK ring: lookups set the reference
+    /// bit of the entry, and insertions sweep the ring to drop expired entries
+    /// and, when over budget, evict the first entry not used since the last
+    /// sweep. Evicted entries are pruned like by remove().
+    /// @param policy The limits of the cache.
+    void setCachePolicy(const CachePolicy &policy)
+    {
+#if __cplusplus >= 201103L
+        // Automatically lock and unlock the mutex.
+        auto lock = this->acquire();
+#endif
+        _cache.policy = policy;
+        if (!_cache.enabled) {
+            _cache.enabled = true;
+            // Track the entries inserted before enabling the cache mode.
+            std::vector<std::shared_ptr<CNode<T>>> stack;
+            if (_root) {
+                stack.push_back(_root);
+            }
+            while (!stack.empty()) {
+                auto node = std::move(stack.back());
+                stack.pop_back();
+                for (std::size_t i = 0; i < MAX_KEYS; ++i) {
+                    auto child = node->at(static_cast<key_t>(i));
+                    if (child) {
+                        stack.push_back(std::move(child));
+                    }
+                }
+                if (node->getSNode()) {
+                    _cache.ring.push_back(CacheEntry{node, node->getSNode()});
+                }
+            }
+        }
+        this->maintainCache();
+    }
+
+    /// @brief Enable, resize or disable the prefix index.
+    /// @details The index maps the key prefixes whose length is a multiple of
+    /// stride to their node, so that find() and remove() jump straight to the
+    /// deepest indexed level of the key with a single hash probe and only walk
+    /// the remaining characters. It pays off when many keys share long
+    /// prefixes, at the cost of one table entry per indexed node, which is
+    /// included in stats().bytes and in the maxBytes budget of the cache.
+    /// @param stride The distance between indexed depths, zero to disable the index.
+    void setPrefixIndex(std::size_t stride)
+    {
+#if __cplusplus >= 201103L
+        // Automatically lock and unlock the mutex.
+        auto lock = this->acquire();
+#endif
+        _index        = PrefixIndex();
+        _index.stride = stride;
+        if (stride == 0 || !_root) {
+            return;
+        }
+        // Index the nodes already in the tree.
+        std::vector<std::pair<std::shared_ptr<CNode<T>>, std::string>> stack;
+        stack.emplace_back(_root, std::string());
+        while (!stack.empty()) {
+            auto node   = std::move(stack.back().first);
+            auto prefix = std::move(stack.back().second);
+            stack.pop_back();
+            if (!prefix.empty()) {
+                this->indexUnlocked(prefix, prefix.size(), node);
+            }
+            for (std::size_t i = 0; i < MAX_KEYS; ++i) {
+                auto child = node->at(static_cast<key_t>(i));
+                if (child) {
+                    stack.emplace_back(std::move(child), prefix + static_cast<char>(i));
+                }
+            }
+        }
+    }
+
+    /// @brief Remove all the entries from the trie.
+    /// @details The old tree is detached under the lock and destroyed after
+    /// releasing it, either here or on the reclaimer thread if one is set.
+    void clear()
+    {
+        std::shared_ptr<CNode<T>> old;
+        // The index is emptied, but keeps its stride.
+        PrefixIndex oldIndex;
+        oldIndex.stride = _index.stride;
+        {
+#if __cplusplus >= 201103L
+            // Automatically lock and unlock the mutex.
+            auto lock = this->acquire();
+#endif
+            old.swap(_root);
+            std::swap(oldIndex, _index);
+            _size  = 0;
+            _nodes = 0;
+            _cache.ring.clear();
+            _cache.hand = 0;
+        }
+        this->dispose(std::move(old), std::move(oldIndex));
+    }
+
+#if __cplusplus >= 201103L
+    /// @brief Set the reclaimer that destroys the trees dropped by clear() and
+    /// by the destructor, keeping their deallocation off the calling thread.
+    /// @param reclaimer The reclaimer to use, or nullptr to destroy trees in place.
+    void setReclaimer(std::shared_ptr<Reclaimer> reclaimer)
+    {
+        // Automatically lock and unlock the mutex.
+        auto lock   = this->acquire();
+        _reclaimer = std::move(reclaimer);
+    }
+#endif
+
+    /// @brief Collect statistics about the structure of the trie.
+    /// @details The structural part is computed by visiting the whole tree
+    /// under the lock, while the runtime counters are only populated when the
+    /// library is compiled with CTRIE_ENABLE_INSTRUMENTATION defined.
+    /// @return The statistics of the trie.
+    auto stats() const -> CTrieStats
+    {
+        CTrieStats result;
+        {
+#if __cplusplus >= 201103L
+            // Automatically lock and unlock the mutex.
+            auto lock = this->acquire();
+#endif
+            std::size_t totalDepth = 0;
+            std::size_t emptySlots = 0;
+            // Visit the tree iteratively, keeping track of the depth of each node.
+            std::vector<std::pair<const CNode<T> *, std::size_t>> stack;
+            if (_root) {
+                stack.emplace_back(_root.get(), 0);
+            }
+            while (!stack.empty()) {
+                auto node  = stack.back().first;
+                auto depth = stack.back().second;
+                stack.pop_back();
+                std::size_t fanOut = 0;
+                for (std::size_t i = 0; i < MAX_KEYS; ++i) {
+                    auto child = node->at(static_cast<key_t>(i));
+                    if (child) {
+                        stack.emplace_back(child.get(), depth + 1);
+                        ++fanOut;
+                    }
+                }
+                ++result.nodes;
+                ++result.nodesByFanOut[CTrieStats::fanOutClass(fanOut)];
+                emptySlots += MAX_KEYS - fanOut;
+                if (node->getSNode()) {
+                    ++result.keys;
+                    totalDepth += depth;
+                    result.maxDepth = std::max(result.maxDepth, depth);
+                }
+            }
+            result.bytes       = estimateBytes(result.nodes, result.keys, _cache.ring.size(), _index);
+            result.evictions   = _cache.evictions;
+            result.expirations = _cache.expirations;
+            if (result.keys > 0) {
+                result.averageDepth = static_cast<double>(totalDepth) / static_cast<double>(result.keys);
+            }
+            if (result.nodes > 0) {
+                result.emptySlotRatio =
+                    static_cast<double>(emptySlots) / static_cast<double>(result.nodes * MAX_KEYS);
+            }
+        }
+#ifdef CTRIE_ENABLE_INSTRUMENTATION
+        _counters.aggregate(result);
+#endif
+        return result;
+    }
+
+    /// @brief Visit all the entries in key order.
+    /// @details The visitor runs under the lock, so it must not use the trie.
+    /// @param visitor Called with the key and the value of each entry.
+    template <typename Visitor>
+    void forEach(Visitor visitor) const
+    {
+        this->forEachPrefix(std::string(), visitor);
+    }
+
+    /// @brief Visit, in key order, all the entries whose key starts with prefix.
+    /// @details The visitor runs under the lock, so it must not use the trie.
+    /// @param prefix The prefix of the keys to visit, empty for all the keys.
+    /// @param visitor Called with the key and the value of each entry.
+    template <typename Visitor>
+    void forEachPrefix(const std::string &prefix, Visitor visitor) const
+    {
+#if __cplusplus >= 201103L
+        // Automatically lock and unlock the mutex.
+        auto lock = this->acquire();
+#endif
+        const CNode<T> *node = _root.get();
+        for (std::size_t i = 0; node && i < prefix.size(); ++i) {
+            auto index = static_cast<std::size_t>(prefix[i]);
+            node       = index < MAX_KEYS ? node->at(prefix[i]).get() : nullptr;
+        }
+        if (node) {
+            node->visit(prefix, visitor);
+        }
+    }
+
+    /// @brief Write the tree structure to the given stream.
+    /// @param os The output stream.
+    void print(std::ostream &os) const
+    {
+#if __cplusplus >= 201103L
+        // Automatically lock and unlock the mutex.
+        auto lock = this->acquire();
+#endif
+        if (_root) {
+            _root->print(os);
+        }
+    }
+
+    /// @brief Write one "key<TAB>value" line per entry, in key order.
+    /// @details Values are written with their operator<<. Tabs, newlines and
+    /// backslashes inside keys and values are escaped as "\\t", "\\n" and "\\\\".
+    /// @param os The output stream.
+    void dump(std::ostream &os) const
+    {
+#if __cplusplus >= 201103L
+        // Automatically lock and unlock the mutex.
+        auto lock = this->acquire();
+#endif
+        if (!_root) {
+            return;
+        }
+        // Values are formatted like the stream would, then escaped like the keys.
+        std::ostringstream buffer;
+        buffer.copyfmt(os);
+        _root->visit(std::string(), [&os, &buffer](const std::string &key, const T &value) {
+            escape(os, key);
+            os << '\t';
+            buffer.str(std::string());
+            buffer << value;
+            escape(os, buffer.str());
+            os << '\n';
+        });
+    }
+
     /// @brief Get the string representation of the tree.
     /// @return A string representing the tree.
     auto toString() const -> std::string
     {
-        if (_root) {
-            return _root->toString();
-        }
-        return std::string();
+        std::stringstream ss;
+        this->print(ss);
+        return ss.str();
     }
 
 private:
+    /// @brief The type of the time to live of the entries.
+    using ttl_t = std::chrono::steady_clock::duration;
+
+    /// @brief An entry of the CLOCK ring used in cache mode.
+    struct CacheEntry {
+        /// The node holding the entry.
+        std::weak_ptr<CNode<T>> node;
+        /// The value of the entry, used to detect removed or replaced entries.
+        std::weak_ptr<SNode<T>> snode;
+    };
+
+    /// @brief The state of the cache mode.
+    struct CacheState {
+        /// Whether the cache mode is enabled.
+        bool enabled = false;
+        /// The limits of the cache.
+        CachePolicy policy;
+        /// The CLOCK ring of the tracked entries.
+        std::vector<CacheEntry> ring;
+        /// The position of the CLOCK hand inside the ring.
+        std::size_t hand = 0;
+        /// Number of evicted entries.
+        std::uint64_t evictions = 0;
+        /// Number of expired entries removed.
+        std::uint64_t expirations = 0;
+    };
+
+    /// @brief A node reachable through the prefix index.
+    struct IndexEntry {
+        /// The key prefix leading to the node.
+        std::string prefix;
+        /// The node at the end of the prefix.
+        std::shared_ptr<CNode<T>> node;
+    };
+
+    /// @brief The jump table over the nodes at every stride-th depth.
+    struct PrefixIndex {
+        /// The distance between indexed depths, zero when the index is disabled.
+        std::size_t stride = 0;
+        /// False after a hash collision left a node out, making misses inconclusive.
+        bool complete = true;
+        /// The total length of the indexed prefixes.
+        std::size_t characters = 0;
+        /// The indexed nodes, by hash of their prefix.
+        std::unordered_map<std::uint64_t, IndexEntry> entries;
+    };
+
+    /// @brief Hash the first characters of a key (64-bit FNV-1a).
+    /// @param key The key.
+    /// @param length The number of characters to hash.
+    /// @return The hash of the prefix.
+    static auto hashPrefix(const std::string &key, std::size_t length) -> std::uint64_t
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < length; ++i) {
+            hash ^= static_cast<unsigned char>(key[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /// @brief Write a field of the dump, escaping the separators.
+    /// @param os The output stream.
+    /// @param field The key or the formatted value.
+    static void escape(std::ostream &os, const std::string &field)
+    {
+        for (char ch : field) {
+            switch (ch) {
+            case '\t':
+                os << "\\t";
+                break;
+            case '\n':
+                os << "\\n";
+                break;
+            case '\\':
+                os << "\\\\";
+                break;
+            default:
+                os << ch;
+            }
+        }
+    }
+
+    /// @brief Check that all the characters of a key fit in the children arrays.
+    /// @param key The key.
+    /// @param what The message of the exception.
+    /// @throws std::out_of_range if a character is out of bounds.
+    static void checkKey(const std::string &key, const char *what)
+    {
+        for (char ch : key) {
+            if (static_cast<std::size_t>(ch) >= MAX_KEYS) {
+                throw std::out_of_range(what);
+            }
+        }
+    }
+
+    /// @brief Estimate the heap bytes used by the trie.
+    /// @param nodes The number of nodes.
+    /// @param keys The number of values.
+    /// @param tracked The number of entries of the CLOCK ring.
+    /// @param index The prefix index.
+    /// @return The estimated bytes, excluding memory owned by T.
+    static auto estimateBytes(std::size_t nodes, std::size_t keys, std::size_t tracked, const PrefixIndex &index)
+        -> std::size_t
+    {
+        // Each node and value lives in a single make_shared allocation,
+        // which also holds the vtable pointer and the two reference counts.
+        const std::size_t controlBlock = sizeof(void *) + 2 * sizeof(long);
+        // Each index entry is a hash node with a next pointer, plus its prefix
+        // and, once the table is populated, its share of the bucket array.
+        const std::size_t indexEntry =
+            sizeof(typename std::unordered_map<std::uint64_t, IndexEntry>::value_type) + sizeof(void *);
+        const std::size_t buckets = index.entries.empty() ? 0 : index.entries.bucket_count();
+        return nodes * (sizeof(CNode<T>) + controlBlock) + keys * (sizeof(SNode<T>) + controlBlock) +
+               tracked * sizeof(CacheEntry) + index.entries.size() * indexEntry + buckets * sizeof(void *) +
+               index.characters;
+    }
+
+    /// @brief Inserts the key-value pair, with the mutex already locked.
+    /// @param key The key to insert, not empty.
+    /// @param value The value associated with the key.
+    /// @param ttl The time to live of the entry, zero for no expiry.
+    void insertUnlocked(const std::string &key, const T &value, ttl_t ttl)
+    {
+        // Reject the key before linking in any node for its prefix.
+        checkKey(key, "insert: key out of bounds");
+        // Count the allocations performed by this insertion.
+        std::uint64_t allocations = 0;
+        // Initialize the root node if it doesn't exist.
+        if (!_root) {
+            _root = std::make_shared<CNode<T>>(nullptr, 0);
+            ++allocations;
+        }
+        // Start from the root node.
+        auto node = _root;
+        // Traverse the Trie, creating child nodes if they don't exist.
+        for (std::size_t depth = 0; depth < key.size(); ++depth) {
+            const auto ch = key[depth];
+            auto child    = node->at(ch);
+            // Create a new child node if the current character doesn't exist.
+            if (!child) {
+                child = std::make_shared<CNode<T>>(node, ch);
+                node->insertChild(ch, child);
+                this->indexUnlocked(key, depth + 1, child);
+                ++allocations;
+            }
+            // Move to the next child node.
+            node = child;
+        }
+        _nodes += static_cast<std::size_t>(allocations);
+        allocations += this->storeUnlocked(node, value, ttl);
+#ifdef CTRIE_ENABLE_INSTRUMENTATION
+        detail::CounterBlock::add(_counters.local().allocations, allocations);
+#endif
+        if (_cache.enabled) {
+            this->maintainCache(node.get());
+        }
+    }
+
+    /// @brief Set the value of a node, updating it in place if present.
+    /// @param node The node of the key, with the mutex already locked.
+    /// @param value The value to store.
+    /// @param ttl The time to live of the entry, zero for no expiry.
+    /// @return The number of allocations performed.
+    auto storeUnlocked(const std::shared_ptr<CNode<T>> &node, const T &value, ttl_t ttl) -> std::uint64_t
+    {
+        std::uint64_t allocations = 0;
+        auto snode                = node->getSNode();
+        if (snode) {
+            snode->setValue(value);
+            snode->touch();
+        } else {
+            node->setSNode(value);
+            snode = node->getSNode();
+            ++allocations;
+            ++_size;
+            if (_cache.enabled) {
+                _cache.ring.push_back(CacheEntry{node, snode});
+            }
+        }
+        snode->setExpiry(
+            ttl > ttl_t::zero() ? std::chrono::steady_clock::now() + ttl : std::chrono::steady_clock::time_point::max());
+        return allocations;
+    }
+
+    /// @brief Remove the value of a node and prune its chain of empty nodes.
+    /// @param node The node holding the value, with the mutex already locked.
+    /// @param key The key of the node, or nullptr if the caller does not know it.
+    /// @return The number of nodes pruned from the tree.
+    auto eraseUnlocked(std::shared_ptr<CNode<T>> node, const std::string *key = nullptr) -> std::size_t
+    {
+        std::size_t pruned = 0;
+        // Clear the stored value.
+        node->clearSNode();
+        --_size;
+        // The key of the node, rebuilt from the parents only if unknown and needed.
+        std::string rebuilt;
+        std::size_t depth = key ? key->size() : 0;
+        // Remove nodes up the parent chain if they meet removal conditions.
+        while (node) {
+            auto parent = node->getParent();
+            if (!node->hasChildren() && parent && !node->getSNode()) {
+                if (_index.stride > 0) {
+                    if (!key) {
+                        for (auto current = node; current->getParent(); current = current->getParent()) {
+                            rebuilt.push_back(current->getKey());
+                        }
+                        std::reverse(rebuilt.begin(), rebuilt.end());
+                        key   = &rebuilt;
+                        depth = rebuilt.size();
+                    }
+                    this->unindexUnlocked(*key, depth--);
+                }
+                parent->removeChild(node->getKey());
+                --_nodes;
+                ++pruned;
+                // Move to the parent node.
+                node = parent;
+            } else {
+                // Stop if the current node shouldn't be removed.
+                break;
+            }
+        }
+        return pruned;
+    }
+
+    /// @brief Jump to the deepest indexed node on the path of a key.
+    /// @param key The key, not empty.
+    /// @param node The node to start from, replaced by the node reached, or by
+    /// nullptr if the index proves that the key is absent.
+    /// @return The depth of the node reached.
+    auto jumpUnlocked(const std::string &key, std::shared_ptr<CNode<T>> &node) const -> std::size_t
+    {
+        if (_index.stride == 0 || key.size() < _index.stride) {
+            return 0;
+        }
+        const auto depth = key.size() - key.size() % _index.stride;
+        auto it          = _index.entries.find(hashPrefix(key, depth));
+        if (it != _index.entries.end() && key.compare(0, depth, it->second.prefix) == 0) {
+            node = it->second.node;
+            return depth;
+        }
+        // Every node at an indexed depth is in the table, unless a collision left it out.
+        if (_index.complete) {
+            node = nullptr;
+        }
+        return 0;
+    }
+
+    /// @brief Add a new node to the prefix index, if it lies at an indexed depth.
+    /// @param key The key being inserted.
+    /// @param depth The depth of the node.
+    /// @param node The node.
+    void indexUnlocked(const std::string &key, std::size_t depth, const std::shared_ptr<CNode<T>> &node)
+    {
+        if (_index.stride == 0 || depth % _index.stride != 0) {
+            return;
+        }
+        auto &entry = _index.entries[hashPrefix(key, depth)];
+        if (entry.node) {
+            // Another prefix with the same hash owns the slot.
+            _index.complete = false;
+            return;
+        }
+        entry.prefix = key.substr(0, depth);
+        entry.node   = node;
+        _index.characters += depth;
+    }
+
+    /// @brief Remove a pruned node from the prefix index.
+    /// @param key A key passing through the node.
+    /// @param depth The depth of the node.
+    void unindexUnlocked(const std::string &key, std::size_t depth)
+    {
+        if (depth % _index.stride != 0) {
+            return;
+        }
+        auto it = _index.entries.find(hashPrefix(key, depth));
+        if (it != _index.entries.end() && key.compare(0, depth, it->second.prefix) == 0) {
+            _index.characters -= it->second.prefix.size();
+            _index.entries.erase(it);
+        }
+    }
+
+    /// @brief Check if the cache is above its limits.
+    /// @return true if some entries must be evicted.
+    auto overBudget() const -> bool
+    {
+        if (_cache.policy.maxEntries > 0 && _size > _cache.policy.maxEntries) {
+            return true;
+        }
+        return _cache.policy.maxBytes > 0 &&
+               estimateBytes(_nodes, _size, _cache.ring.size(), _index) > _cache.policy.maxBytes;
+    }
+
+    /// @brief Check the entry under the CLOCK hand, dropping it if stale or expired.
+    /// @param now The current time.
+    /// @return The node of the entry if it is still live, nullptr if it was dropped.
+    auto inspectHand(std::chrono::steady_clock::time_point now) -> std::shared_ptr<CNode<T>>
+    {
+        auto &entry = _cache.ring[_cache.hand];
+        auto node   = entry.node.lock();
+        auto snode  = entry.snode.lock();
+        // The entry was removed, or removed and inserted again.
+        if (!node || !snode || node->getSNode() != snode) {
+            node.reset();
+        } else if (snode->isExpired(now)) {
+            this->eraseUnlocked(node);
+            ++_cache.expirations;
+            node.reset();
+        }
+        if (!node) {
+            // Replace the entry with the last one, the hand stays in place.
+            _cache.ring[_cache.hand] = std::move(_cache.ring.back());
+            _cache.ring.pop_back();
+        }
+        return node;
+    }
+
+    /// @brief Reclaim a bounded number of expired entries, then evict entries
+    /// until the cache is within its limits.
+    /// @param protect A node that must not be evicted, like the one just inserted.
+    void maintainCache(const CNode<T> *protect = nullptr)
+    {
+        auto now = std::chrono::steady_clock::now();
+        // Incremental expiry, amortized over the insertions.
+        auto budget = std::min(_cache.policy.expiryBudget, _cache.ring.size());
+        for (std::size_t i = 0; i < budget && !_cache.ring.empty(); ++i) {
+            if (_cache.hand >= _cache.ring.size()) {
+                _cache.hand = 0;
+            }
+            if (this->inspectHand(now)) {
+                ++_cache.hand;
+            }
+        }
+        // CLOCK eviction: give a second chance to the recently used entries.
+        while (!_cache.ring.empty() && this->overBudget()) {
+            if (_cache.hand >= _cache.ring.size()) {
+                _cache.hand = 0;
+            }
+            auto node = this->inspectHand(now);
+            if (!node) {
+                continue;
+            }
+            if (node.get() == protect) {
+                // Nothing else left to evict.
+                if (_cache.ring.size() == 1) {
+                    break;
+                }
+                ++_cache.hand;
+                continue;
+            }
+            if (node->getSNode()->clearReferenced()) {
+                ++_cache.hand;
+                continue;
+            }
+            this->eraseUnlocked(node);
+            ++_cache.evictions;
+            _cache.ring[_cache.hand] = std::move(_cache.ring.back());
+            _cache.ring.pop_back();
+        }
+    }
+
+    /// @brief A detached tree, along with the index pointing into it.
+    struct Detached {
+        /// The root of the tree.
+        std::shared_ptr<CNode<T>> tree;
+        /// The index, destroyed first so that the tree goes as a whole.
+        PrefixIndex index;
+    };
+
+    /// @brief Destroy a detached tree and its index, possibly on the reclaimer thread.
+    /// @param tree The tree to destroy.
+    /// @param index The index of the tree.
+    void dispose(std::shared_ptr<CNode<T>> tree, PrefixIndex index)
+    {
+#if __cplusplus >= 201103L
+        std::shared_ptr<Reclaimer> reclaimer;
+        {
+            // Automatically lock and unlock the mutex.
+            auto lock = this->acquire();
+            reclaimer = _reclaimer;
+        }
+        if (reclaimer) {
+            if (index.entries.empty()) {
+                reclaimer->retire(std::move(tree));
+                return;
+            }
+            auto detached   = std::make_shared<Detached>();
+            detached->tree  = std::move(tree);
+            detached->index = std::move(index);
+            reclaimer->retire(std::move(detached));
+            return;
+        }
+#endif
+        // Drop the references held by the index, so that the tree goes as a whole.
+        index.entries.clear();
+        // The destructor of CNode takes the subtree apart iteratively.
+        tree.reset();
+    }
+
+#if __cplusplus >= 201103L
+    /// @brief Lock the internal mutex, recording the wait when instrumented.
+    /// @return The lock owning the internal mutex.
+    auto acquire() const -> std::unique_lock<std::mutex>
+    {
+#ifdef CTRIE_ENABLE_INSTRUMENTATION
+        auto start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto wait  = std::chrono::steady_clock::now() - start;
+        auto &block = _counters.local();
+        detail::CounterBlock::add(block.lockAcquisitions, 1);
+        detail::CounterBlock::add(
+            block.lockWaitNanoseconds,
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count()));
+        return lock;
+#else
+        return std::unique_lock<std::mutex>(_mutex);
+#endif
+    }
+#endif
+
     /// The root of the tree.
     std::shared_ptr<CNode<T>> _root;
+    /// The number of stored values.
+    std::size_t _size = 0;
+    /// The number of nodes, including the root.
+    std::size_t _nodes = 0;
+    /// The state of the cache mode.
+    CacheState _cache;
+    /// The optional jump table over the upper levels of the tree.
+    PrefixIndex _index;
 #if __cplusplus >= 201103L
     /// Internal mutex for thread safety.
     mutable std::mutex _mutex;
+    /// Optional reclaimer destroying the detached trees.
+    std::shared_ptr<Reclaimer> _reclaimer;
+#endif
+#ifdef CTRIE_ENABLE_INSTRUMENTATION
+    /// Per-thread runtime counters.
+    mutable detail::CounterRegistry _counters;
 #endif
 };
 
+#if __cplusplus >= 201103L
+/// @brief A handle publishing whole tries with a single atomic pointer swap.
+/// @details Readers take a snapshot with load() and keep using it for as long
+/// as they need, while a writer builds a replacement off to the side and
+/// publishes it. A version is destroyed when its last reader drops it, on the
+/// reclaimer thread if the handle has one.
+template <typename T>
+class AtomicTrieHandle
+{
+public:
+    /// @brief The type of a snapshot of the published trie.
+    using snapshot_t = std::shared_ptr<const CTrie<T>>;
+
+    /// @brief Construct a handle publishing an empty trie.
+    AtomicTrieHandle()
+        : current(std::make_shared<const CTrie<T>>())
+        , reclaimer()
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Construct a handle publishing the given trie.
+    /// @param trie The trie to publish.
+    explicit AtomicTrieHandle(CTrie<T> &&trie)
+        : current(std::make_shared<const CTrie<T>>(std::move(trie)))
+        , reclaimer()
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The instance to copy from.
+    AtomicTrieHandle(const AtomicTrieHandle &other) = delete;
+
+    /// @brief Copy assignment operator.
+    /// @param other The instance to copy from.
+    /// @return Reference to the instance.
+    auto operator=(const AtomicTrieHandle &other) -> AtomicTrieHandle & = delete;
+
+    /// @brief Move constructor.
+    /// @param other The instance to move from.
+    AtomicTrieHandle(AtomicTrieHandle &&other) = delete;
+
+    /// @brief Move assignment operator.
+    /// @param other The instance to move from.
+    /// @return Reference to the instance.
+    auto operator=(AtomicTrieHandle &&other) -> AtomicTrieHandle & = delete;
+
+    /// @brief Destroy the handle, readers keep their snapshots alive.
+    ~AtomicTrieHandle() = default;
+
+    /// @brief Set the reclaimer given to every trie published from now on.
+    /// @param _reclaimer The reclaimer, or nullptr to destroy versions in place.
+    void setReclaimer(std::shared_ptr<Reclaimer> _reclaimer)
+    {
+        std::lock_guard<std::mutex> lock(writer);
+        reclaimer = std::move(_reclaimer);
+    }
+
+    /// @brief Take a snapshot of the currently published trie.
+    /// @return The snapshot, valid for as long as the caller holds it.
+    auto load() const -> snapshot_t
+    {
+#if __cplusplus >= 202002L
+        return current.load();
+#else
+        return std::atomic_load(&current);
+#endif
+    }
+
+    /// @brief Publish a new trie.
+    /// @param trie The trie to publish.
+    /// @return The previously published version.
+    auto publish(CTrie<T> &&trie) -> snapshot_t { return this->publish(std::make_shared<CTrie<T>>(std::move(trie))); }
+
+    /// @brief Publish a new trie.
+    /// @param trie The trie to publish, which should not be modified afterwards.
+    /// @return The previously published version.
+    auto publish(std::shared_ptr<CTrie<T>> trie) -> snapshot_t
+    {
+        std::lock_guard<std::mutex> lock(writer);
+        if (reclaimer) {
+            trie->setReclaimer(reclaimer);
+        }
+        snapshot_t next(std::move(trie));
+#if __cplusplus >= 202002L
+        return current.exchange(std::move(next));
+#else
+        return std::atomic_exchange(&current, std::move(next));
+#endif
+    }
+
+    /// @brief Find the value associated with the passed key in the current version.
+    /// @param key the key to use for the search.
+    /// @param value the output variable where the found value is stored.
+    /// @return true if we have found the value, false otherwise.
+    auto find(const std::string &key, T &value) const -> bool { return this->load()->find(key, value); }
+
+private:
+    /// The currently published version.
+#if __cplusplus >= 202002L
+    std::atomic<snapshot_t> current;
+#else
+    snapshot_t current;
+#endif
+    /// Serializes publishers and protects the reclaimer.
+    std::mutex writer;
+    /// The reclaimer given to the published tries.
+    std::shared_ptr<Reclaimer> reclaimer;
+};
+#endif
+
 } // namespace ctrie
 
 /// @brief Overload of the operator << for the CTrie class.
@@ -444,6 +1958,6 @@ private:
 template <typename T>
 auto operator<<(std::ostream &lhs, const ctrie::CTrie<T> &rhs) -> std::ostream &
 {
-    lhs << rhs.toString();
+    rhs.print(lhs);
     return lhs;
 }
@@ -0,0 +1,444 @@
+/// @file sharded_ctrie.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief A prefix tree partitioned across independent shards.
+#pragma once
+
+#include "ctrie/ctrie.hpp"
+
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+
+namespace ctrie
+{
+
+namespace detail
+{
+
+/// @brief The size assumed for a cache line.
+constexpr std::size_t CACHE_LINE = 64;
+
+/// @brief Base of the types allocated on their own cache lines.
+/// @details Allocations aligned beyond the fundamental alignment need C++17,
+/// so the blocks are aligned by hand, remembering where each one starts.
+struct CacheAligned {
+    /// @brief Allocate an object.
+    /// @param size The size of the object.
+    /// @return The aligned block.
+    static auto operator new(std::size_t size) -> void * { return allocate(size); }
+
+    /// @brief Allocate an array.
+    /// @param size The size of the array.
+    /// @return The aligned block.
+    static auto operator new[](std::size_t size) -> void * { return allocate(size); }
+
+    /// @brief Release an object.
+    /// @param block The aligned block.
+    static void operator delete(void *block) noexcept { release(block); }
+
+    /// @brief Release an array.
+    /// @param block The aligned block.
+    static void operator delete[](void *block) noexcept { release(block); }
+
+private:
+    /// @brief Allocate a block starting on a cache line.
+    /// @param size The size of the block.
+    /// @return The aligned block.
+    static auto allocate(std::size_t size) -> void *
+    {
+        // Room for the alignment and for the start of the allocation.
+        auto space = size + CACHE_LINE;
+        auto *base = ::operator new(space + sizeof(void *));
+        void *block = static_cast<char *>(base) + sizeof(void *);
+        std::align(CACHE_LINE, size, block, space);
+        static_cast<void **>(block)[-1] = base;
+        return block;
+    }
+
+    /// @brief Release a block allocated by allocate().
+    /// @param block The aligned block.
+    static void release(void *block) noexcept
+    {
+        if (block != nullptr) {
+            ::operator delete(static_cast<void **>(block)[-1]);
+        }
+    }
+};
+
+} // namespace detail
+
+/// @brief How the keys are assigned to the shards.
+enum class ShardRouting {
+    /// Contiguous ranges of the first character, keeping the shards ordered.
+    LeadingByte,
+    /// A hash of the whole key, spreading the load evenly.
+    Hash,
+    /// New keys go to the home shard of the inserting thread, see bindThread().
+    Affinity
+};
+
+/// @brief A prefix tree partitioned across independent tries.
+/// @details Each shard has its own root and mutex, so threads working on
+/// different shards never touch the same cache lines. A shard is allocated by
+/// the first thread writing into it. With Affinity routing each worker
+/// inserts into its own shard, so the default first-touch policy of the
+/// operating system places the shard, and the nodes its owner allocates, on
+/// the NUMA node of that worker. A directory, split in stripes by hash of the
+/// key, records the shard of each key, so that every operation visits a
+/// single shard and two threads never both add the same key.
+template <typename T>
+class ShardedCTrie
+{
+public:
+    /// @brief Construct a new sharded trie.
+    /// @param shards The number of shards, zero for one per hardware thread.
+    /// @param _routing How the keys are assigned to the shards.
+    explicit ShardedCTrie(std::size_t shards = 0, ShardRouting _routing = ShardRouting::LeadingByte)
+        : routing(_routing)
+        , stride(0)
+        , tries(shards == 0 ? std::max(1U, std::thread::hardware_concurrency()) : shards)
+        , stripes(new Stripe[STRIPES])
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The instance to copy from.
+    ShardedCTrie(const ShardedCTrie &other) = delete;
+
+    /// @brief Copy assignment operator.
+    /// @param other The instance to copy from.
+    /// @return Reference to the instance.
+    auto operator=(const ShardedCTrie &other) -> ShardedCTrie & = delete;
+
+    /// @brief Move constructor.
+    /// @details The moved-from trie is left empty, with the same shards and routing.
+    /// @param other The instance to move from.
+    ShardedCTrie(ShardedCTrie &&other)
+        : routing(other.routing)
+        , stride(other.stride.load())
+        , tries(other.tries.size())
+        , stripes(new Stripe[STRIPES])
+    {
+        tries.swap(other.tries);
+        stripes.swap(other.stripes);
+    }
+
+    /// @brief Move assignment operator.
+    /// @details The moved-from trie is left empty, with the same shards and routing.
+    /// @param other The instance to move from.
+    /// @return Reference to the instance.
+    auto operator=(ShardedCTrie &&other) -> ShardedCTrie &
+    {
+        if (this != &other) {
+            // The previous shards are destroyed along with moved.
+            ShardedCTrie moved(std::move(other));
+            std::swap(routing, moved.routing);
+            stride = moved.stride.exchange(stride.load());
+            tries.swap(moved.tries);
+            stripes.swap(moved.stripes);
+        }
+        return *this;
+    }
+
+    /// @brief Destroy the sharded trie.
+    virtual ~ShardedCTrie()
+    {
+        for (auto &entry : tries) {
+            delete entry.load();
+        }
+    }
+
+    /// @brief Get the number of shards.
+    /// @return The number of shards.
+    auto shardCount() const -> std::size_t { return tries.size(); }
+
+    /// @brief Get a shard, allocating it on the calling thread if needed.
+    /// @details With Affinity routing, the shards must only be modified
+    /// through the sharded trie, which keeps track of where each key lives.
+    /// @param index The index of the shard.
+    /// @return The trie of the shard.
+    auto shard(std::size_t index) -> CTrie<T> & { return this->ensure(tries.at(index)).trie; }
+
+    /// @brief Get a shard, allocating it on the calling thread if needed.
+    /// @param index The index of the shard.
+    /// @return The trie of the shard.
+    auto shard(std::size_t index) const -> const CTrie<T> & { return this->ensure(tries.at(index)).trie; }
+
+    /// @brief Set the home shard of the calling thread, used by Affinity routing.
+    /// @details Threads that never call this get a home shard in round-robin.
+    /// @param index The index of the shard, taken modulo the number of shards.
+    static void bindThread(std::size_t index) { homeShard() = index; }
+
+    /// @brief Inserts the key-value pair into the shard owning the key.
+    /// @param key The key to insert.
+    /// @param value The value associated with the key.
+    /// @return true if the insertion was successful, false otherwise.
+    auto insert(const std::string &key, T value) -> bool
+    {
+        if (routing == ShardRouting::Affinity) {
+            // Looking for the owner and inserting the key must be a single step.
+            auto &stripe = this->stripe(key);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            // Update the key where it already lives, otherwise keep it local.
+            auto owner = stripe.owners.find(key);
+            if (owner != stripe.owners.end()) {
+                return this->ensure(tries[owner->second]).trie.insert(key, std::move(value));
+            }
+            auto index = this->home();
+            if (!this->ensure(tries[index]).trie.insert(key, std::move(value))) {
+                return false;
+            }
+            stripe.owners.emplace(key, index);
+            return true;
+        }
+        return this->ensure(tries[this->route(key)]).trie.insert(key, std::move(value));
+    }
+
+    /// @brief Find the value associated with the passed key.
+    /// @param key the key to use for the search.
+    /// @param value the output variable where the found value is stored.
+    /// @return true if we have found the value, false otherwise.
+    auto find(const std::string &key, T &value) const -> bool
+    {
+        auto index = this->route(key);
+        if (routing == ShardRouting::Affinity) {
+            auto &stripe = this->stripe(key);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            auto owner = stripe.owners.find(key);
+            if (owner == stripe.owners.end()) {
+                return false;
+            }
+            index = owner->second;
+        }
+        // Shards nobody wrote into yet hold no keys.
+        auto *entry = tries[index].load();
+        return entry != nullptr && entry->trie.find(key, value);
+    }
+
+    /// @brief Removes the key-value pair from the shard owning the key.
+    /// @param key The key to remove.
+    /// @return true if the removal was successful, false otherwise.
+    auto remove(const std::string &key) -> bool
+    {
+        if (routing == ShardRouting::Affinity) {
+            auto &stripe = this->stripe(key);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            auto owner = stripe.owners.find(key);
+            if (owner == stripe.owners.end()) {
+                return false;
+            }
+            auto removed = this->ensure(tries[owner->second]).trie.remove(key);
+            stripe.owners.erase(owner);
+            return removed;
+        }
+        auto *entry = tries[this->route(key)].load();
+        return entry != nullptr && entry->trie.remove(key);
+    }
+
+    /// @brief Get the number of entries of all the shards.
+    /// @return The number of entries.
+    auto size() const -> std::size_t
+    {
+        std::size_t result = 0;
+        for (const auto &entry : tries) {
+            auto *shard = entry.load();
+            result += shard != nullptr ? shard->trie.size() : 0;
+        }
+        return result;
+    }
+
+    /// @brief Remove all the entries from all the shards.
+    void clear()
+    {
+        // Directory first: a concurrent insertion can then leave an owner
+        // without its key, which is harmless, but never a key without owner.
+        for (std::size_t i = 0; i < STRIPES; ++i) {
+            std::lock_guard<std::mutex> lock(stripes[i].mutex);
+            stripes[i].owners.clear();
+        }
+        for (auto &entry : tries) {
+            auto *shard = entry.load();
+            if (shard != nullptr) {
+                shard->trie.clear();
+            }
+        }
+    }
+
+    /// @brief Enable, resize or disable the prefix index of every shard.
+    /// @param stride The distance between indexed depths, zero to disable the index.
+    void setPrefixIndex(std::size_t _stride)
+    {
+        // Shards allocated from now on pick up the stride on their own.
+        stride = _stride;
+        for (auto &entry : tries) {
+            auto *shard = entry.load();
+            if (shard != nullptr) {
+                shard->trie.setPrefixIndex(_stride);
+            }
+        }
+    }
+
+    /// @brief Visit all the entries of all the shards in key order.
+    /// @details Each shard is read under its own lock, so concurrent writers
+    /// may be observed on some shards and not on others.
+    /// @param visitor Called with the key and the value of each entry.
+    template <typename Visitor>
+    void forEach(Visitor visitor) const
+    {
+        this->forEachPrefix(std::string(), visitor);
+    }
+
+    /// @brief Visit, in key order, the entries of all shards starting with prefix.
+    /// @details Each shard is read under its own lock, so concurrent writers
+    /// may be observed on some shards and not on others.
+    /// @param prefix The prefix of the keys to visit, empty for all the keys.
+    /// @param visitor Called with the key and the value of each entry.
+    template <typename Visitor>
+    void forEachPrefix(const std::string &prefix, Visitor visitor) const
+    {
+        if (routing == ShardRouting::LeadingByte) {
+            // The shards hold contiguous and ordered ranges of keys.
+            if (!prefix.empty()) {
+                auto *shard = tries[this->route(prefix)].load();
+                if (shard != nullptr) {
+                    shard->trie.forEachPrefix(prefix, visitor);
+                }
+                return;
+            }
+            for (const auto &entry : tries) {
+                auto *shard = entry.load();
+                if (shard != nullptr) {
+                    shard->trie.forEachPrefix(prefix, visitor);
+                }
+            }
+            return;
+        }
+        // Collect the ordered entries of each shard, then merge them.
+        using entry_t = std::pair<std::string, T>;
+        std::vector<std::vector<entry_t>> runs(tries.size());
+        for (std::size_t i = 0; i < tries.size(); ++i) {
+            auto *shard = tries[i].load();
+            if (shard == nullptr) {
+                continue;
+            }
+            auto &run = runs[i];
+            shard->trie.forEachPrefix(
+                prefix, [&run](const std::string &key, const T &value) { run.emplace_back(key, value); });
+        }
+        // Min-heap of (run, position), ordered by the key at that position.
+        using cursor_t = std::pair<std::size_t, std::size_t>;
+        auto greater   = [&runs](const cursor_t &lhs, const cursor_t &rhs) {
+            return runs[lhs.first][lhs.second].first > runs[rhs.first][rhs.second].first;
+        };
+        std::priority_queue<cursor_t, std::vector<cursor_t>, decltype(greater)> heap(greater);
+        for (std::size_t i = 0; i < runs.size(); ++i) {
+            if (!runs[i].empty()) {
+                heap.push(cursor_t(i, 0));
+            }
+        }
+        while (!heap.empty()) {
+            auto cursor = heap.top();
+            heap.pop();
+            const auto &entry = runs[cursor.first][cursor.second];
+            visitor(entry.first, entry.second);
+            if (++cursor.second < runs[cursor.first].size()) {
+                heap.push(cursor);
+            }
+        }
+    }
+
+private:
+    /// @brief The number of stripes of the Affinity directory.
+    static constexpr std::size_t STRIPES = 64;
+
+    /// @brief A shard, aligned so that two shards never share a cache line.
+    struct alignas(detail::CACHE_LINE) Shard : detail::CacheAligned {
+        /// The trie of the shard.
+        CTrie<T> trie;
+    };
+
+    /// @brief A stripe of the Affinity directory, on its own cache line.
+    struct alignas(detail::CACHE_LINE) Stripe : detail::CacheAligned {
+        /// Serializes the updates of the keys of the stripe.
+        std::mutex mutex;
+        /// The shard holding each key of the stripe.
+        std::unordered_map<std::string, std::size_t> owners;
+    };
+
+    /// @brief Get a shard, allocating it on the calling thread on first use.
+    /// @param entry The slot of the shard.
+    /// @return The shard.
+    auto ensure(std::atomic<Shard *> &entry) const -> Shard &
+    {
+        auto *shard = entry.load();
+        if (shard == nullptr) {
+            std::unique_ptr<Shard> fresh(new Shard());
+            auto _stride = stride.load();
+            if (_stride != 0) {
+                fresh->trie.setPrefixIndex(_stride);
+            }
+            // Another thread may have allocated the shard in the meantime.
+            if (entry.compare_exchange_strong(shard, fresh.get())) {
+                shard = fresh.release();
+            }
+        }
+        return *shard;
+    }
+
+    /// @brief Get the shard owning the key, for LeadingByte and Hash routing.
+    /// @param key The key.
+    /// @return The index of the shard.
+    auto route(const std::string &key) const -> std::size_t
+    {
+        if (key.empty()) {
+            return 0;
+        }
+        if (routing == ShardRouting::Hash) {
+            return std::hash<std::string>()(key) % tries.size();
+        }
+        auto byte = static_cast<std::size_t>(static_cast<unsigned char>(key[0]));
+        return std::min(tries.size() - 1, byte * tries.size() / MAX_KEYS);
+    }
+
+    /// @brief Get the stripe of the Affinity directory holding a key.
+    /// @param key The key.
+    /// @return The stripe of the key.
+    auto stripe(const std::string &key) const -> Stripe &
+    {
+        return stripes[std::hash<std::string>()(key) % STRIPES];
+    }
+
+    /// @brief Get the home shard of the calling thread.
+    /// @return The index of the shard.
+    auto home() const -> std::size_t
+    {
+        auto &index = homeShard();
+        if (index == std::numeric_limits<std::size_t>::max()) {
+            static std::atomic<std::size_t> next(0);
+            index = next++;
+        }
+        return index % tries.size();
+    }
+
+    /// @brief Get the home shard of the calling thread, shared by all instances.
+    /// @return Reference to the thread-local index.
+    static auto homeShard() -> std::size_t &
+    {
+        static thread_local std::size_t index = std::numeric_limits<std::size_t>::max();
+        return index;
+    }
+
+    /// How the keys are assigned to the shards.
+    ShardRouting routing;
+    /// The stride of the prefix index of the shards, zero if disabled.
+    std::atomic<std::size_t> stride;
+    /// The shards, allocated on first use.
+    mutable std::vector<std::atomic<Shard *>> tries;
+    /// The Affinity directory, split by hash of the key.
+    std::unique_ptr<Stripe[]> stripes;
+};
+
+} // namespace ctrie
@@ -0,0 +1,263 @@
+/// @file static_ctrie.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief A prefix tree built at compile time from a fixed set of keys.
+#pragma once
+
+#if __cplusplus >= 201703L
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace ctrie
+{
+
+namespace detail
+{
+
+/// @brief Marks a missing state, value or key of a StaticCTrie.
+constexpr std::uint32_t STATIC_NONE = 0xFFFFFFFFU;
+
+/// @brief A state of the automaton of a StaticCTrie.
+struct StaticState {
+    /// The first edge of the state.
+    std::uint32_t edgeBegin = 0;
+    /// The number of edges of the state.
+    std::uint32_t edgeCount = 0;
+    /// The key ending in this state, or STATIC_NONE.
+    std::uint32_t key = STATIC_NONE;
+    /// The only key below this state, or STATIC_NONE if there are more.
+    std::uint32_t single = STATIC_NONE;
+};
+
+/// @brief A transition between two states of a StaticCTrie.
+struct StaticEdge {
+    /// The character of the transition.
+    char label = 0;
+    /// The target state.
+    std::uint32_t target = 0;
+};
+
+/// @brief The flat tables of the automaton of a StaticCTrie.
+/// @tparam States The maximum number of states.
+template <std::size_t States>
+struct StaticTables {
+    /// The transitions of the root, indexed by the first character.
+    std::array<std::uint32_t, 256> root{};
+    /// The states, the root is the first one.
+    std::array<StaticState, States> state{};
+    /// The edges of all the states, grouped by source state.
+    std::array<StaticEdge, States> edge{};
+    /// The number of states actually used.
+    std::size_t states = 0;
+    /// The length of the longest key.
+    std::size_t maxLength = 0;
+};
+
+/// @brief The maximum number of states: the root, plus one per character.
+/// @tparam Table The table of keys and values.
+/// @return The maximum number of states.
+template <const auto &Table>
+constexpr auto staticMaxStates() -> std::size_t
+{
+    std::size_t result = 1;
+    for (const auto &entry : Table) {
+        result += entry.first.size();
+    }
+    return result;
+}
+
+/// @brief Build the automaton of a table; invalid tables stop the compilation.
+/// @tparam Table The table of keys and values.
+/// @return The tables of the automaton.
+template <const auto &Table>
+constexpr auto staticBuild() -> StaticTables<staticMaxStates<Table>()>
+{
+    constexpr std::size_t KEYS   = std::size(Table);
+    constexpr std::size_t STATES = staticMaxStates<Table>();
+    constexpr std::uint32_t NONE = STATIC_NONE;
+    StaticTables<STATES> result{};
+    // Visit the keys in lexicographic order, so that children are created sorted.
+    std::array<std::size_t, KEYS> order{};
+    for (std::size_t i = 0; i < KEYS; ++i) {
+        order[i] = i;
+    }
+    for (std::size_t i = 1; i < KEYS; ++i) {
+        for (std::size_t j = i; j > 0 && Table[order[j]].first < Table[order[j - 1]].first; --j) {
+            auto tmp     = order[j];
+            order[j]     = order[j - 1];
+            order[j - 1] = tmp;
+        }
+    }
+    // Build a first-child / next-sibling tree, counting the keys below each state.
+    std::array<std::uint32_t, STATES> firstChild{};
+    std::array<std::uint32_t, STATES> lastChild{};
+    std::array<std::uint32_t, STATES> nextSibling{};
+    std::array<char, STATES> label{};
+    std::array<std::uint32_t, STATES> below{};
+    for (std::size_t s = 0; s < STATES; ++s) {
+        firstChild[s] = lastChild[s] = nextSibling[s] = NONE;
+    }
+    std::size_t states = 1;
+    for (std::size_t i = 0; i < KEYS; ++i) {
+        const auto index = static_cast<std::uint32_t>(order[i]);
+        const auto key   = Table[index].first;
+        if (key.empty()) {
+            throw "StaticCTrie: empty keys are not allowed";
+        }
+        result.maxLength    = key.size() > result.maxLength ? key.size() : result.maxLength;
+        std::uint32_t state = 0;
+        ++below[0];
+        for (std::size_t d = 0; d < key.size(); ++d) {
+            // Keys are sorted, so a new child is always the last one.
+            auto child = lastChild[state];
+            if (child == NONE || label[child] != key[d]) {
+                child        = static_cast<std::uint32_t>(states++);
+                label[child] = key[d];
+                if (lastChild[state] == NONE) {
+                    firstChild[state] = child;
+                } else {
+                    nextSibling[lastChild[state]] = child;
+                }
+                lastChild[state] = child;
+            }
+            state = child;
+            ++below[state];
+        }
+        if (result.state[state].key != NONE) {
+            throw "StaticCTrie: duplicate keys are not allowed";
+        }
+        result.state[state].key = index;
+    }
+    // Lay out the edges of each state next to each other.
+    std::uint32_t edges = 0;
+    for (std::size_t s = 0; s < states; ++s) {
+        result.state[s].edgeBegin = edges;
+        for (auto child = firstChild[s]; child != NONE; child = nextSibling[child]) {
+            result.edge[edges++] = StaticEdge{label[child], child};
+        }
+        result.state[s].edgeCount = edges - result.state[s].edgeBegin;
+    }
+    // Find the states leading to a single key.
+    for (std::size_t s = 0; s < states; ++s) {
+        if (below[s] == 1) {
+            auto state = static_cast<std::uint32_t>(s);
+            while (result.state[state].key == NONE) {
+                state = firstChild[state];
+            }
+            result.state[s].single = result.state[state].key;
+        }
+    }
+    // The dense table of the root.
+    for (auto &target : result.root) {
+        target = NONE;
+    }
+    for (auto child = firstChild[0]; child != NONE; child = nextSibling[child]) {
+        result.root[static_cast<unsigned char>(label[child])] = child;
+    }
+    result.states = states;
+    return result;
+}
+
+} // namespace detail
+
+/// @brief A prefix tree built at compile time from a table of keys and values.
+/// @details The table must be an array of std::pair<std::string_view, T> with
+/// static storage duration, for instance:
+/// @code
+/// static constexpr std::pair<std::string_view, int> methods[] = {{"GET", 1}, {"POST", 2}};
+/// constexpr ctrie::StaticCTrie<methods> lookup;
+/// @endcode
+/// The transitions are stored in flat arrays computed by the compiler, so
+/// there is no initialization and no allocation at runtime. The root uses a
+/// dense table indexed by the first character, inner states keep their sorted
+/// edges next to each other, and once a single key is left below a state the
+/// rest of the token is compared in one go.
+/// @tparam Table The table of keys and values.
+template <const auto &Table>
+class StaticCTrie
+{
+public:
+    /// @brief The type of the entries of the table.
+    using entry_t = std::remove_cv_t<std::remove_reference_t<decltype(Table[0])>>;
+    /// @brief The type of the values.
+    using value_t = typename entry_t::second_type;
+
+    /// @brief The number of keys.
+    static constexpr std::size_t KEYS = std::size(Table);
+
+    /// @brief Find the value associated with the passed key.
+    /// @param key the key to use for the search.
+    /// @param value the output variable where the found value is stored.
+    /// @return true if we have found the value, false otherwise.
+    constexpr auto find(std::string_view key, value_t &value) const -> bool
+    {
+        auto index = StaticCTrie::lookup(key);
+        if (index == detail::STATIC_NONE) {
+            return false;
+        }
+        value = Table[index].second;
+        return true;
+    }
+
+    /// @brief Check if the key is in the table.
+    /// @param key the key to use for the search.
+    /// @return true if the key is in the table, false otherwise.
+    constexpr auto contains(std::string_view key) const -> bool
+    {
+        return StaticCTrie::lookup(key) != detail::STATIC_NONE;
+    }
+
+    /// @brief Get the number of states of the automaton.
+    /// @return The number of states, including the root.
+    static constexpr auto stateCount() -> std::size_t { return tables.states; }
+
+private:
+    /// @brief Find the index of the key inside the table.
+    /// @param key the key to use for the search.
+    /// @return The index of the key, detail::STATIC_NONE if not found.
+    static constexpr auto lookup(std::string_view key) -> std::uint32_t
+    {
+        if (key.empty() || key.size() > tables.maxLength) {
+            return detail::STATIC_NONE;
+        }
+        auto state = tables.root[static_cast<unsigned char>(key[0])];
+        for (std::size_t d = 1; state != detail::STATIC_NONE; ++d) {
+            const auto &current = tables.state[state];
+            // A single key is left: compare the rest of the token at once.
+            if (current.single != detail::STATIC_NONE) {
+                const auto &candidate = Table[current.single].first;
+                if (candidate.size() == key.size() && candidate.substr(d) == key.substr(d)) {
+                    return current.single;
+                }
+                return detail::STATIC_NONE;
+            }
+            if (d == key.size()) {
+                return current.key;
+            }
+            // The edges are sorted, so we can stop at the first larger label.
+            auto next = detail::STATIC_NONE;
+            for (auto e = current.edgeBegin; e < current.edgeBegin + current.edgeCount; ++e) {
+                const auto edge = static_cast<unsigned char>(tables.edge[e].label);
+                const auto ch   = static_cast<unsigned char>(key[d]);
+                if (edge >= ch) {
+                    next = edge == ch ? tables.edge[e].target : detail::STATIC_NONE;
+                    break;
+                }
+            }
+            state = next;
+        }
+        return detail::STATIC_NONE;
+    }
+
+    /// The tables of the automaton, computed at compile time.
+    static constexpr auto tables = detail::staticBuild<Table>();
+};
+
+} // namespace ctrie
+
+#endif
@@ -0,0 +1,71 @@
+/// @file test_atomic_handle.cpp
+/// @brief Test for publishing whole tries while readers are running.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#include "ctrie/ctrie.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#define KEYS     32
+#define VERSIONS 200
+
+/// @brief Build a version of the dictionary, where every key holds the version.
+static auto build(int version) -> ctrie::CTrie<int>
+{
+    ctrie::CTrie<int> trie;
+    for (int i = 0; i < KEYS; ++i) {
+        trie.insert("key" + std::to_string(i), version);
+    }
+    return trie;
+}
+
+int main()
+{
+    ctrie::AtomicTrieHandle<int> handle(build(0));
+    handle.setReclaimer(std::make_shared<ctrie::Reclaimer>());
+
+    std::atomic<bool> done(false);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            int last = 0;
+            while (!done.load()) {
+                // A snapshot is a single, complete version.
+                auto snapshot = handle.load();
+                int first = 0;
+                if (!snapshot->find("key0", first) || first < last) {
+                    failed = true;
+                }
+                for (int i = 1; i < KEYS; ++i) {
+                    int value;
+                    if (!snapshot->find("key" + std::to_string(i), value) || value != first) {
+                        failed = true;
+                    }
+                }
+                last = first;
+            }
+        });
+    }
+    for (int version = 1; version <= VERSIONS; ++version) {
+        handle.publish(build(version));
+    }
+    done = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    if (failed) {
+        std::cerr << "A reader observed an inconsistent version.\n";
+        return 1;
+    }
+    int value;
+    if (!handle.find("key7", value) || value != VERSIONS) {
+        std::cerr << "The last version was not published.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+/// @file test_cache.cpp
+/// @brief Test for the bounded cache mode, with TTL expiry and CLOCK eviction.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#include "ctrie/ctrie.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+int main()
+{
+    int value;
+
+    // Entry budget with CLOCK eviction.
+    {
+        ctrie::CTrie<int> cache;
+        ctrie::CachePolicy policy;
+        policy.maxEntries = 3;
+        cache.setCachePolicy(policy);
+        cache.insert("alpha", 1);
+        cache.insert("beta", 2);
+        cache.insert("gamma", 3);
+        // Using alpha gives it a second chance, so beta is evicted instead.
+        cache.find("alpha", value);
+        cache.insert("delta", 4);
+        if (cache.size() != 3 || !cache.find("alpha", value) || cache.find("beta", value) ||
+            !cache.find("delta", value)) {
+            std::cerr << "Wrong CLOCK eviction.\n";
+            return 1;
+        }
+        if (cache.stats().evictions != 1) {
+            std::cerr << "Wrong number of evictions.\n";
+            return 1;
+        }
+        // Removed and inserted again, the entry is tracked only once.
+        cache.remove("gamma");
+        cache.insert("gamma", 5);
+        if (cache.size() != 3 || !cache.find("gamma", value) || value != 5) {
+            std::cerr << "Wrong reinsertion.\n";
+            return 1;
+        }
+    }
+
+    // Evicted entries are pruned from the tree.
+    {
+        ctrie::CTrie<int> cache;
+        ctrie::CachePolicy policy;
+        policy.maxEntries = 1;
+        cache.setCachePolicy(policy);
+        cache.insert("a-long-key", 1);
+        cache.insert("b", 2);
+        auto stats = cache.stats();
+        if (stats.keys != 1 || stats.nodes != 2) {
+            std::cerr << "Evicted entries were not pruned: " << stats.nodes << " nodes.\n";
+            return 1;
+        }
+    }
+
+    // Time to live, reclaimed incrementally by the insertions.
+    {
+        ctrie::CTrie<int> cache;
+        cache.setCachePolicy(ctrie::CachePolicy());
+        cache.insert("short", 1, std::chrono::milliseconds(1));
+        cache.insert("forever", 2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        if (cache.find("short", value) || !cache.find("forever", value)) {
+            std::cerr << "Expired entries are still visible.\n";
+            return 1;
+        }
+        cache.insert("other", 3);
+        if (cache.size() != 2 || cache.stats().expirations != 1) {
+            std::cerr << "Expired entries were not reclaimed.\n";
+            return 1;
+        }
+    }
+
+    // Memory budget, also applied to the entries inserted before.
+    {
+        ctrie::CTrie<int> cache;
+        for (int i = 0; i < 100; ++i) {
+            cache.insert("key" + std::to_string(i), i);
+        }
+        auto full = cache.stats().bytes;
+        ctrie::CachePolicy policy;
+        policy.maxBytes = full / 4;
+        cache.setCachePolicy(policy);
+        for (int i = 100; i < 200; ++i) {
+            cache.insert("key" + std::to_string(i), i);
+        }
+        auto stats = cache.stats();
+        if (stats.bytes > policy.maxBytes || stats.keys == 0 || !cache.find("key199", value)) {
+            std::cerr << "Memory budget not respected: " << stats.bytes << " > " << policy.maxBytes << "\n";
+            return 1;
+        }
+    }
+
+    // A key out of bounds leaves the trie, and its node count, untouched.
+    {
+        ctrie::CTrie<int> cache;
+        ctrie::CachePolicy policy;
+        policy.maxBytes = 1 << 20;
+        cache.setCachePolicy(policy);
+        try {
+            cache.insert(std::string("ab") + static_cast<char>(-1), 1);
+            std::cerr << "Expected an exception for a key out of bounds.\n";
+            return 1;
+        } catch (const std::out_of_range &) {
+            // Expected.
+        }
+        if (cache.stats().nodes != 0) {
+            std::cerr << "A rejected key left nodes behind.\n";
+            return 1;
+        }
+        // Pruning those nodes must not corrupt the count used by the budget.
+        cache.insert("abc", 2);
+        cache.remove("abc");
+        cache.insert("x", 3);
+        cache.insert("y", 4);
+        if (!cache.find("x", value) || !cache.find("y", value) || cache.stats().evictions != 0) {
+            std::cerr << "Entries were evicted within the memory budget.\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+/// @file test_clear.cpp
+/// @brief Test for clearing and destroying deep tries, in place and in background.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#include "ctrie/ctrie.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+/// @brief Records the thread destroying the last copy of a value.
+struct Witness {
+    /// @brief Construct a new witness.
+    /// @param _thread Where to record the destroying thread.
+    explicit Witness(std::atomic<std::thread::id> &_thread)
+        : thread(_thread)
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Record the calling thread.
+    ~Witness() { thread = std::this_thread::get_id(); }
+
+    /// Where to record the destroying thread.
+    std::atomic<std::thread::id> &thread;
+};
+
+/// @brief Wait for the reclaimer to destroy everything it was given.
+static void drain(const ctrie::Reclaimer &reclaimer)
+{
+    while (reclaimer.pending() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+int main()
+{
+    int value;
+    // Deep enough to overflow the stack with a recursive teardown.
+    std::string deep(50000, 'd');
+
+    // Destruction of a deep trie.
+    {
+        ctrie::CTrie<int> trie;
+        trie.insert(deep, 1);
+    }
+
+    // Clearing in place.
+    ctrie::CTrie<int> trie;
+    trie.insert(deep, 1);
+    trie.insert("key", 2);
+    trie.clear();
+    if (trie.find(deep, value) || trie.find("key", value) || trie.stats().nodes != 0) {
+        std::cerr << "The trie was not cleared.\n";
+        return 1;
+    }
+    // The trie can be reused after being cleared.
+    trie.insert("key", 3);
+    if (!trie.find("key", value) || value != 3) {
+        std::cerr << "The trie cannot be reused after clear.\n";
+        return 1;
+    }
+
+    // Clearing and destroying through a reclaimer.
+    auto reclaimer = std::make_shared<ctrie::Reclaimer>();
+    {
+        ctrie::CTrie<int> background;
+        background.setReclaimer(reclaimer);
+        background.insert(deep, 1);
+        background.clear();
+        if (background.find(deep, value)) {
+            std::cerr << "The trie was not cleared.\n";
+            return 1;
+        }
+        background.insert(deep, 2);
+    }
+    drain(*reclaimer);
+
+    // Repeated reloads by move assignment all go through the reclaimer.
+    // The witnesses outlive the trie, whose last tree is destroyed on the reclaimer.
+    std::atomic<std::thread::id> freed[3];
+    for (auto &thread : freed) {
+        thread = std::thread::id();
+    }
+    {
+        ctrie::CTrie<std::shared_ptr<Witness>> serving;
+        serving.setReclaimer(reclaimer);
+        serving.insert("key", std::make_shared<Witness>(freed[0]));
+        for (int reload = 1; reload <= 2; ++reload) {
+            ctrie::CTrie<std::shared_ptr<Witness>> fresh;
+            fresh.insert("key", std::make_shared<Witness>(freed[reload]));
+            serving = std::move(fresh);
+            // The reclaimer destroys the tree after taking it off its queue.
+            for (int wait = 0; wait < 5000 && freed[reload - 1].load() == std::thread::id(); ++wait) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (freed[reload - 1].load() == std::this_thread::get_id() ||
+                freed[reload - 1].load() == std::thread::id()) {
+                std::cerr << "Reload " << reload << " did not free the old tree on the reclaimer.\n";
+                return 1;
+            }
+        }
+        if (reclaimer.use_count() != 2) {
+            std::cerr << "The serving trie lost its reclaimer.\n";
+            return 1;
+        }
+    }
+    drain(*reclaimer);
+    if (freed[2].load() == std::this_thread::get_id() || freed[2].load() == std::thread::id()) {
+        std::cerr << "The last tree was not freed on the reclaimer.\n";
+        return 1;
+    }
+
+    // The index goes to the reclaimer along with the tree it points into.
+    std::atomic<std::thread::id> indexed;
+    indexed = std::thread::id();
+    {
+        ctrie::CTrie<std::shared_ptr<Witness>> withIndex;
+        withIndex.setReclaimer(reclaimer);
+        withIndex.setPrefixIndex(2);
+        withIndex.insert("/index/key", std::make_shared<Witness>(indexed));
+        withIndex.clear();
+        drain(*reclaimer);
+        if (indexed.load() == std::this_thread::get_id() || indexed.load() == std::thread::id()) {
+            std::cerr << "Clearing did not free the indexed tree on the reclaimer.\n";
+            return 1;
+        }
+        // The cleared trie keeps its index, which goes along with the tree on destruction.
+        ctrie::CTrie<std::shared_ptr<Witness>> withoutIndex;
+        indexed = std::thread::id();
+        withIndex.insert("/index/key", std::make_shared<Witness>(indexed));
+        withoutIndex.insert("/index/key", nullptr);
+        if (withIndex.stats().bytes <= withoutIndex.stats().bytes) {
+            std::cerr << "Clearing disabled the index.\n";
+            return 1;
+        }
+    }
+    drain(*reclaimer);
+    if (indexed.load() == std::this_thread::get_id() || indexed.load() == std::thread::id()) {
+        std::cerr << "The destructor did not free the indexed tree on the reclaimer.\n";
+        return 1;
+    }
+    // Clearing while another thread looks up keys.
+    ctrie::CTrie<int> shared;
+    std::atomic<bool> done(false);
+    std::thread reader([&shared, &done] {
+        int v;
+        while (!done) {
+            shared.find("key", v);
+            shared.remove("other");
+        }
+    });
+    for (int i = 0; i < 2000; ++i) {
+        shared.insert("key", i);
+        shared.clear();
+    }
+    done = true;
+    reader.join();
+    return 0;
+}
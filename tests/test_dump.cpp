@@ -0,0 +1,77 @@
+/// @file test_dump.cpp
+/// @brief Test for the streaming pretty-print and the machine-readable dump.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#include "ctrie/ctrie.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+int main()
+{
+    ctrie::CTrie<int> trie;
+    trie.insert("ab", 1);
+    trie.insert("b", 2);
+    trie.insert("a", 3);
+    trie.insert("a\tb", 4);
+
+    // The dump lists the entries in key order, one per line.
+    std::ostringstream dump;
+    trie.dump(dump);
+    if (dump.str() != "a\t3\na\\tb\t4\nab\t1\nb\t2\n") {
+        std::cerr << "Wrong dump:\n" << dump.str();
+        return 1;
+    }
+
+    // Values are escaped like the keys, and formatted like the stream would.
+    ctrie::CTrie<std::string> texts;
+    texts.insert("a\\b", "one\ttwo\nthree\\");
+    ctrie::CTrie<double> numbers;
+    numbers.insert("pi", 3.14159);
+    std::ostringstream textDump;
+    std::ostringstream numberDump;
+    texts.dump(textDump);
+    numberDump << std::fixed << std::setprecision(2);
+    numbers.dump(numberDump);
+    if (textDump.str() != "a\\\\b\tone\\ttwo\\nthree\\\\\n" || numberDump.str() != "pi\t3.14\n") {
+        std::cerr << "Wrong dump of the values:\n" << textDump.str() << numberDump.str();
+        return 1;
+    }
+
+    // The stream operator and toString produce the same tree.
+    std::ostringstream tree;
+    tree << trie;
+    std::string expected = std::string(1, '\0') + "\n" +
+                           "  ├─a : 3\n"
+                           "  │ ├─\t\n"
+                           "  │ │ └─b : 4\n"
+                           "  │ └─b : 1\n"
+                           "  └─b : 2\n";
+    if (tree.str() != expected || trie.toString() != expected) {
+        std::cerr << "Wrong tree:\n" << tree.str();
+        return 1;
+    }
+
+    // Deep keys are printed without recursion.
+    ctrie::CTrie<int> deep;
+    std::string key(10000, 'x');
+    deep.insert(key, 7);
+    std::ostringstream deepDump;
+    deep.dump(deepDump);
+    if (deepDump.str() != key + "\t7\n") {
+        std::cerr << "Wrong dump of the deep key.\n";
+        return 1;
+    }
+    // The indentation of the tree grows with the depth, so keep it smaller.
+    ctrie::CTrie<int> shallower;
+    shallower.insert(std::string(2000, 'x'), 7);
+    std::ostringstream deepTree;
+    shallower.print(deepTree);
+    if (deepTree.str().find(" : 7\n") == std::string::npos) {
+        std::cerr << "Wrong tree of the deep key.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+/// @file test_instrumentation.cpp
+/// @brief Test for the optional runtime counters of the CTrie.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#define CTRIE_ENABLE_INSTRUMENTATION
+#include "ctrie/ctrie.hpp"
+
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    ctrie::CTrie<int> trie;
+    int value;
+
+    // Two allocations for the root and the node, plus one for the value.
+    trie.insert("a", 1);
+    // Two nodes and a value.
+    trie.insert("abc", 2);
+
+    // Lookups from different threads are aggregated on read.
+    std::thread worker([&trie] {
+        int v;
+        trie.find("abc", v);
+        trie.find("zzz", v);
+    });
+    worker.join();
+    trie.find("a", value);
+
+    auto stats = trie.stats();
+    if (stats.allocations != 6) {
+        std::cerr << "Wrong allocations: " << stats.allocations << "\n";
+        return 1;
+    }
+    if (stats.lookups != 3 || stats.lookupPathLength != 4 || stats.maxLookupPathLength != 3) {
+        std::cerr << "Wrong lookups: " << stats.lookups << " / " << stats.lookupPathLength << " / "
+                  << stats.maxLookupPathLength << "\n";
+        return 1;
+    }
+    // Two insertions, three lookups and the stats call itself.
+    if (stats.lockAcquisitions != 6) {
+        std::cerr << "Wrong lock acquisitions: " << stats.lockAcquisitions << "\n";
+        return 1;
+    }
+
+    // Threads alternating between many tries, like the shards of a ShardedCTrie.
+    const std::size_t tries = 16;
+    const int rounds        = 100;
+    std::vector<std::unique_ptr<ctrie::CTrie<int>>> many;
+    for (std::size_t i = 0; i < tries; ++i) {
+        many.emplace_back(new ctrie::CTrie<int>());
+        many.back()->insert("key", 1);
+    }
+    auto alternate = [&many] {
+        int v;
+        for (int round = 0; round < rounds; ++round) {
+            for (auto &entry : many) {
+                entry->find("key", v);
+            }
+        }
+    };
+    std::thread first(alternate);
+    std::thread second(alternate);
+    first.join();
+    second.join();
+    for (auto &entry : many) {
+        auto counters = entry->stats();
+        if (counters.lookups != 2 * rounds || counters.lockAcquisitions != 2 * rounds + 2) {
+            std::cerr << "Wrong counters with many tries: " << counters.lookups << " / "
+                      << counters.lockAcquisitions << "\n";
+            return 1;
+        }
+    }
+
+    // The counters of destroyed tries do not leak into new ones.
+    for (int i = 0; i < 1000; ++i) {
+        ctrie::CTrie<int> shortLived;
+        shortLived.insert("key", 1);
+        shortLived.find("key", value);
+        if (shortLived.stats().lookups != 1) {
+            std::cerr << "Counters leaked between tries.\n";
+            return 1;
+        }
+    }
+    return 0;
+}
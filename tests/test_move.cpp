@@ -0,0 +1,56 @@
+/// @file test_move.cpp
+/// @brief Test for moving tries and storing them in containers.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#include "ctrie/ctrie.hpp"
+
+#include <iostream>
+#include <vector>
+
+int main()
+{
+    int value;
+
+    ctrie::CTrie<int> source;
+    source.insert("alpha", 1);
+    source.insert("beta", 2);
+
+    // Move construction leaves the source empty.
+    ctrie::CTrie<int> moved(std::move(source));
+    if (!moved.find("alpha", value) || value != 1 || source.find("alpha", value)) {
+        std::cerr << "Move construction failed.\n";
+        return 1;
+    }
+
+    // Move assignment replaces the previous content.
+    ctrie::CTrie<int> target;
+    target.insert("gamma", 3);
+    target = std::move(moved);
+    if (!target.find("beta", value) || value != 2 || target.find("gamma", value) || moved.find("beta", value)) {
+        std::cerr << "Move assignment failed.\n";
+        return 1;
+    }
+
+    // Moved-from tries are still usable.
+    moved.insert("delta", 4);
+    if (!moved.find("delta", value) || value != 4) {
+        std::cerr << "Moved-from trie is not usable.\n";
+        return 1;
+    }
+
+    // Tries can be stored in containers.
+    std::vector<ctrie::CTrie<int>> tries;
+    for (int i = 0; i < 16; ++i) {
+        ctrie::CTrie<int> trie;
+        trie.insert("key", i);
+        tries.push_back(std::move(trie));
+    }
+    for (int i = 0; i < 16; ++i) {
+        if (!tries[static_cast<std::size_t>(i)].find("key", value) || value != i) {
+            std::cerr << "Wrong value in trie " << i << ".\n";
+            return 1;
+        }
+    }
+    return 0;
+}
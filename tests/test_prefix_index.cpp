@@ -0,0 +1,192 @@
+/// @file test_prefix_index.cpp
+/// @brief Test for the prefix index, against a trie without it and a std::map.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#include "ctrie/ctrie.hpp"
+
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+
+int main()
+{
+    int value;
+    ctrie::CTrie<int> trie;
+    trie.insert("/api/v2/tenants/1/users", 1);
+    trie.insert("/api/v2/tenants/2/users", 2);
+    trie.insert("/api", 3);
+    trie.insert("/a", 4);
+
+    // Enabling the index on a populated trie covers the existing nodes.
+    trie.setPrefixIndex(4);
+    if (!trie.find("/api/v2/tenants/1/users", value) || value != 1 || !trie.find("/api", value) || value != 3 ||
+        !trie.find("/a", value) || value != 4) {
+        std::cerr << "Existing keys were not found through the index.\n";
+        return 1;
+    }
+    // Misses, with and without a node at the indexed depth.
+    if (trie.find("/api/v2/tenants/3/users", value) || trie.find("/api/v2/tenants/1/user", value) ||
+        trie.find("/b", value) || trie.find("/api/v", value)) {
+        std::cerr << "Missing keys were found through the index.\n";
+        return 1;
+    }
+
+    // Insertions and removals keep the index consistent.
+    trie.insert("/api/v2/tenants/3/users", 5);
+    if (!trie.find("/api/v2/tenants/3/users", value) || value != 5) {
+        std::cerr << "A key inserted after enabling the index was not found.\n";
+        return 1;
+    }
+    trie.remove("/api/v2/tenants/1/users");
+    if (trie.find("/api/v2/tenants/1/users", value) || !trie.find("/api/v2/tenants/2/users", value) || value != 2) {
+        std::cerr << "Removing a key broke the index.\n";
+        return 1;
+    }
+    // Reinserting below a pruned node must not reach the old, detached nodes.
+    trie.insert("/api/v2/tenants/1/users/42", 6);
+    if (trie.find("/api/v2/tenants/1/users", value) || !trie.find("/api/v2/tenants/1/users/42", value) ||
+        value != 6) {
+        std::cerr << "The index points to pruned nodes.\n";
+        return 1;
+    }
+
+    // Clearing and moving carry the index along with the tree.
+    trie.clear();
+    if (trie.find("/api/v2/tenants/2/users", value)) {
+        std::cerr << "The index survived clear.\n";
+        return 1;
+    }
+    trie.insert("/api/v2/tenants/7/users", 7);
+    ctrie::CTrie<int> moved(std::move(trie));
+    if (!moved.find("/api/v2/tenants/7/users", value) || value != 7) {
+        std::cerr << "The index was not moved with the tree.\n";
+        return 1;
+    }
+
+    // Evictions in cache mode drop the evicted nodes from the index.
+    ctrie::CTrie<int> cache;
+    ctrie::CTrie<int> plain;
+    cache.setPrefixIndex(3);
+    ctrie::CachePolicy policy;
+    policy.maxEntries = 4;
+    cache.setCachePolicy(policy);
+    plain.setCachePolicy(policy);
+    for (int i = 0; i < 16; ++i) {
+        cache.insert("/cache/entry/" + std::to_string(i), i);
+        plain.insert("/cache/entry/" + std::to_string(i), i);
+    }
+    for (int i = 0; i < 16; ++i) {
+        int expected = -1;
+        bool found   = cache.find("/cache/entry/" + std::to_string(i), value);
+        if (found != plain.find("/cache/entry/" + std::to_string(i), expected) || (found && value != expected)) {
+            std::cerr << "Mismatched lookup of the cached entry " << i << ".\n";
+            return 1;
+        }
+    }
+    if (cache.size() != 4) {
+        std::cerr << "Expected 4 cached entries, found " << cache.size() << ".\n";
+        return 1;
+    }
+    // Once every entry is gone, evicted or removed, the index is empty again.
+    for (int i = 0; i < 16; ++i) {
+        cache.remove("/cache/entry/" + std::to_string(i));
+        plain.remove("/cache/entry/" + std::to_string(i));
+    }
+    if (cache.stats().bytes != plain.stats().bytes) {
+        std::cerr << "The index kept entries of evicted or removed nodes.\n";
+        return 1;
+    }
+
+    // The memory of the index is part of the estimated bytes.
+    ctrie::CTrie<int> withIndex;
+    ctrie::CTrie<int> withoutIndex;
+    withIndex.setPrefixIndex(4);
+    for (int i = 0; i < 100; ++i) {
+        withIndex.insert("/api/v2/tenants/" + std::to_string(i), i);
+        withoutIndex.insert("/api/v2/tenants/" + std::to_string(i), i);
+    }
+    if (withIndex.stats().bytes <= withoutIndex.stats().bytes) {
+        std::cerr << "The index is missing from the estimated bytes.\n";
+        return 1;
+    }
+
+    // Keys out of bounds are rejected the same way with and without the index,
+    // wherever the character falls and whether or not its path exists.
+    const std::string invalid[] = {
+        std::string("/api/v2/tenants/1/users") + static_cast<char>(-1),
+        std::string("/ap") + static_cast<char>(-1) + "/v2/tenants/1/users",
+        std::string("/zz") + static_cast<char>(-1),
+    };
+    ctrie::CTrie<int> unindexed;
+    unindexed.insert("/api/v2/tenants/1/users", 1);
+    withIndex.insert("/api/v2/tenants/1/users", 1);
+    for (const auto &key : invalid) {
+        for (auto *target : {&unindexed, &withIndex}) {
+            bool threw[2] = {false, false};
+            try {
+                target->find(key, value);
+            } catch (const std::out_of_range &) {
+                threw[0] = true;
+            }
+            try {
+                target->remove(key);
+            } catch (const std::out_of_range &) {
+                threw[1] = true;
+            }
+            if (!threw[0] || !threw[1]) {
+                std::cerr << "A key out of bounds was not rejected.\n";
+                return 1;
+            }
+        }
+    }
+
+    // Random operations, checked against a std::map.
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> length(1, 12);
+    std::uniform_int_distribution<int> symbol('a', 'c');
+    std::uniform_int_distribution<int> operation(0, 2);
+    ctrie::CTrie<int> indexed;
+    indexed.setPrefixIndex(3);
+    std::map<std::string, int> reference;
+    for (int i = 0; i < 20000; ++i) {
+        std::string key(static_cast<std::size_t>(length(rng)), 'a');
+        for (auto &ch : key) {
+            ch = static_cast<char>(symbol(rng));
+        }
+        switch (operation(rng)) {
+        case 0:
+            indexed.insert(key, i);
+            reference[key] = i;
+            break;
+        case 1:
+            if (indexed.remove(key) != (reference.erase(key) > 0)) {
+                std::cerr << "Mismatched removal of " << key << ".\n";
+                return 1;
+            }
+            break;
+        default: {
+            auto it    = reference.find(key);
+            bool found = indexed.find(key, value);
+            if (found != (it != reference.end()) || (found && value != it->second)) {
+                std::cerr << "Mismatched lookup of " << key << ".\n";
+                return 1;
+            }
+        }
+        }
+    }
+    // Rebuilding the index with another stride keeps the same content.
+    indexed.setPrefixIndex(5);
+    for (const auto &entry : reference) {
+        if (!indexed.find(entry.first, value) || value != entry.second) {
+            std::cerr << "Key " << entry.first << " lost after changing the stride.\n";
+            return 1;
+        }
+    }
+    if (indexed.size() != reference.size()) {
+        std::cerr << "Expected " << reference.size() << " entries, found " << indexed.size() << ".\n";
+        return 1;
+    }
+    return 0;
+}
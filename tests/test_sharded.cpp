@@ -0,0 +1,195 @@
+/// @file test_sharded.cpp
+/// @brief Test for the sharded trie, with every routing mode.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#include "ctrie/sharded_ctrie.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <thread>
+
+/// @brief A value without a default constructor.
+struct Handle {
+    /// @brief Construct a new handle.
+    /// @param _id The identifier of the handle.
+    explicit Handle(int _id)
+        : id(_id)
+    {
+        // Nothing to do.
+    }
+
+    /// The identifier of the handle.
+    int id;
+};
+
+/// @brief Check insert, find, remove, ordered iteration and prefix queries.
+static auto check(ctrie::ShardRouting routing, const char *name) -> bool
+{
+    ctrie::ShardedCTrie<int> trie(4, routing);
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 200; ++i) {
+        auto key = std::string(1, static_cast<char>('a' + (i * 7) % 26)) + "/" + std::to_string(i);
+        trie.insert(key, i);
+        expected[key] = i;
+    }
+    // Updating a key does not duplicate it.
+    trie.insert("a/0", -1);
+    expected["a/0"] = -1;
+    trie.remove("b/9");
+    expected.erase("b/9");
+
+    int value;
+    if (trie.size() != expected.size() || !trie.find("a/0", value) || value != -1 || trie.find("b/9", value)) {
+        std::cerr << name << ": wrong content.\n";
+        return false;
+    }
+    // Merged iteration is ordered across shards.
+    auto it = expected.begin();
+    bool ordered = true;
+    trie.forEach([&](const std::string &key, int v) {
+        if (it == expected.end() || it->first != key || it->second != v) {
+            ordered = false;
+        } else {
+            ++it;
+        }
+    });
+    if (!ordered || it != expected.end()) {
+        std::cerr << name << ": wrong iteration.\n";
+        return false;
+    }
+    // Prefix queries only return the matching keys, in order.
+    std::string last;
+    std::size_t count = 0;
+    trie.forEachPrefix("c/1", [&](const std::string &key, int) {
+        if (key.compare(0, 3, "c/1") != 0 || key < last) {
+            ordered = false;
+        }
+        last = key;
+        ++count;
+    });
+    std::size_t matching = 0;
+    for (const auto &entry : expected) {
+        matching += entry.first.compare(0, 3, "c/1") == 0 ? 1 : 0;
+    }
+    if (!ordered || count != matching || count == 0) {
+        std::cerr << name << ": wrong prefix query.\n";
+        return false;
+    }
+
+    // The moved-from trie is empty and can be reused.
+    ctrie::ShardedCTrie<int> moved(std::move(trie));
+    if (moved.size() != expected.size() || trie.size() != 0 || trie.find("a/0", value) || trie.remove("a/0")) {
+        std::cerr << name << ": wrong content after a move.\n";
+        return false;
+    }
+    trie.insert("a/0", 1);
+    trie = std::move(moved);
+    if (trie.size() != expected.size() || !trie.find("a/0", value) || value != -1 || moved.size() != 0) {
+        std::cerr << name << ": wrong content after a move assignment.\n";
+        return false;
+    }
+    moved.insert("z", 26);
+    if (!moved.find("z", value) || value != 26) {
+        std::cerr << name << ": the moved-from trie cannot be reused.\n";
+        return false;
+    }
+
+    // Clearing empties every shard, along with the directory.
+    trie.clear();
+    if (trie.size() != 0 || trie.find("a/0", value)) {
+        std::cerr << name << ": wrong content after clear.\n";
+        return false;
+    }
+    trie.insert("a/0", 2);
+    if (!trie.find("a/0", value) || value != 2 || trie.size() != 1) {
+        std::cerr << name << ": the trie cannot be reused after clear.\n";
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    if (!check(ctrie::ShardRouting::LeadingByte, "leading byte") || !check(ctrie::ShardRouting::Hash, "hash") ||
+        !check(ctrie::ShardRouting::Affinity, "affinity")) {
+        return 1;
+    }
+
+    // With affinity routing, new keys stay in the shard of their thread.
+    ctrie::ShardedCTrie<int> trie(2, ctrie::ShardRouting::Affinity);
+    std::thread first([&trie] {
+        ctrie::ShardedCTrie<int>::bindThread(0);
+        trie.insert("first", 1);
+    });
+    first.join();
+    std::thread second([&trie] {
+        ctrie::ShardedCTrie<int>::bindThread(1);
+        trie.insert("second", 2);
+        // Existing keys are updated where they live.
+        trie.insert("first", 3);
+    });
+    second.join();
+    int value;
+    if (!trie.shard(0).find("first", value) || value != 3 || !trie.shard(1).find("second", value) ||
+        trie.shard(1).find("first", value)) {
+        std::cerr << "affinity: keys are not in their home shard.\n";
+        return 1;
+    }
+
+    // Shards are allocated on first use, on their own cache lines, and pick up the prefix index.
+    ctrie::ShardedCTrie<int> lazy(2, ctrie::ShardRouting::Affinity);
+    lazy.setPrefixIndex(2);
+    std::thread writer([&lazy] {
+        ctrie::ShardedCTrie<int>::bindThread(1);
+        lazy.insert("/lazy/key", 1);
+    });
+    writer.join();
+    ctrie::CTrie<int> unindexed;
+    unindexed.insert("/lazy/key", 1);
+    if (!lazy.find("/lazy/key", value) || lazy.shard(1).stats().bytes <= unindexed.stats().bytes ||
+        reinterpret_cast<std::uintptr_t>(&lazy.shard(0)) % 64 != 0) {
+        std::cerr << "affinity: shards allocated on first use are not set up.\n";
+        return 1;
+    }
+
+    // Values do not need a default constructor.
+    ctrie::ShardedCTrie<Handle> handles(2, ctrie::ShardRouting::Affinity);
+    handles.insert("handle", Handle(1));
+    handles.insert("handle", Handle(2));
+    Handle handle(0);
+    if (!handles.find("handle", handle) || handle.id != 2 || handles.size() != 1 || !handles.remove("handle") ||
+        handles.remove("handle")) {
+        std::cerr << "affinity: wrong handling of values without a default constructor.\n";
+        return 1;
+    }
+
+    // Threads with different home shards inserting the same new keys at once.
+    ctrie::ShardedCTrie<int> racing(2, ctrie::ShardRouting::Affinity);
+    const int keys = 20000;
+    std::atomic<bool> start(false);
+    auto insertAll = [&racing, &start](std::size_t home) {
+        ctrie::ShardedCTrie<int>::bindThread(home);
+        while (!start) {
+            std::this_thread::yield();
+        }
+        for (int i = 0; i < keys; ++i) {
+            racing.insert("key/" + std::to_string(i), i);
+        }
+    };
+    std::thread left(insertAll, 0);
+    std::thread right(insertAll, 1);
+    start = true;
+    left.join();
+    right.join();
+    std::size_t visited = 0;
+    racing.forEach([&visited](const std::string &, int) { ++visited; });
+    if (racing.size() != keys || visited != keys) {
+        std::cerr << "affinity: concurrent insertions duplicated keys (" << racing.size() << ", " << visited
+                  << ").\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+/// @file test_static_ctrie.cpp
+/// @brief Test for the trie built at compile time.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#include "ctrie/static_ctrie.hpp"
+
+#include <iostream>
+#include <string>
+
+/// The HTTP methods, some sharing prefixes.
+static constexpr std::pair<std::string_view, int> methods[] = {
+    {"GET", 1}, {"HEAD", 2}, {"POST", 3}, {"PUT", 4}, {"DELETE", 5}, {"CONNECT", 6}, {"OPTIONS", 7},
+    {"TRACE", 8}, {"PATCH", 9}, {"P", 10}, {"PO", 11},
+};
+
+/// The automaton, built at compile time.
+static constexpr ctrie::StaticCTrie<methods> lookup;
+
+// Lookups can be evaluated at compile time too.
+static_assert(lookup.contains("GET"), "GET must be found");
+static_assert(lookup.contains("PO"), "PO must be found");
+static_assert(!lookup.contains("GE"), "GE is only a prefix");
+static_assert(!lookup.contains("POSTS"), "POSTS is too long");
+
+int main()
+{
+    for (const auto &entry : methods) {
+        int value = 0;
+        // Runtime strings, to exercise the runtime path.
+        std::string key(entry.first);
+        if (!lookup.find(key, value) || value != entry.second) {
+            std::cerr << "Key " << key << " not found.\n";
+            return 1;
+        }
+    }
+    const char *missing[] = {"", "G", "GOT", "PUTS", "POS", "PA", "get", "\xff", "DELETED", "CONNECTION"};
+    for (const auto *key : missing) {
+        int value = 0;
+        if (lookup.find(key, value)) {
+            std::cerr << "Key " << key << " should not be found.\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+/// @file test_stats.cpp
+/// @brief Test for the structural statistics reported by the CTrie.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#include "ctrie/ctrie.hpp"
+
+#include <iostream>
+
+int main()
+{
+    ctrie::CTrie<int> trie;
+
+    // An empty trie has no nodes at all.
+    auto empty = trie.stats();
+    if (empty.keys != 0 || empty.nodes != 0 || empty.bytes != 0) {
+        std::cerr << "Empty trie reported a non-empty structure.\n";
+        return 1;
+    }
+
+    trie.insert("ab", 1);
+    trie.insert("ac", 2);
+    trie.insert("abcd", 3);
+
+    // root -> a -> {b -> c -> d, c}
+    auto stats = trie.stats();
+    if (stats.keys != 3 || stats.nodes != 6) {
+        std::cerr << "Wrong counts: " << stats.keys << " keys, " << stats.nodes << " nodes.\n";
+        return 1;
+    }
+    // Leaves: c, d. Single child: root, b, bc. Two children: a.
+    if (stats.nodesByFanOut[0] != 2 || stats.nodesByFanOut[1] != 3 || stats.nodesByFanOut[2] != 1) {
+        std::cerr << "Wrong fan-out classes.\n";
+        return 1;
+    }
+    if (stats.maxDepth != 4 || stats.averageDepth < 2.66 || stats.averageDepth > 2.67) {
+        std::cerr << "Wrong depth: " << stats.averageDepth << " / " << stats.maxDepth << "\n";
+        return 1;
+    }
+    if (stats.emptySlotRatio <= 0.9 || stats.emptySlotRatio >= 1.0 || stats.bytes == 0) {
+        std::cerr << "Wrong memory usage.\n";
+        return 1;
+    }
+
+    // Removing a key prunes its chain of nodes.
+    trie.remove("abcd");
+    stats = trie.stats();
+    if (stats.keys != 2 || stats.nodes != 4 || stats.maxDepth != 2) {
+        std::cerr << "Wrong structure after removal.\n";
+        return 1;
+    }
+    return 0;
+}
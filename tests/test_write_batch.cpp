@@ -0,0 +1,127 @@
+/// @file test_write_batch.cpp
+/// @brief Test for applying batches of insertions and removals atomically.
+/// Copyright (c) 2024-2025. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for details.
+
+#include "ctrie/ctrie.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+int main()
+{
+    int value;
+    ctrie::CTrie<int> trie;
+    trie.insert("apple", 1);
+    trie.insert("banana", 2);
+
+    // Empty keys are not queued.
+    ctrie::WriteBatch<int> batch;
+    if (batch.insert("", 0) || batch.remove("") || !batch.empty()) {
+        std::cerr << "Empty keys must be rejected.\n";
+        return 1;
+    }
+
+    // Mixed operations, out of order, sharing prefixes with each other.
+    batch.insert("application", 3);
+    batch.remove("banana");
+    batch.insert("app", 4);
+    batch.remove("missing");
+    batch.insert("apply", 5);
+    batch.insert("app", 6);
+    batch.remove("apple");
+    if (batch.size() != 7) {
+        std::cerr << "Expected 7 operations, found " << batch.size() << ".\n";
+        return 1;
+    }
+    auto changed = trie.apply(batch);
+    if (changed != 6) {
+        std::cerr << "Expected 6 changes, found " << changed << ".\n";
+        return 1;
+    }
+    // The last operation on a key wins.
+    if (!trie.find("app", value) || value != 6) {
+        std::cerr << "The last insertion of a key must win.\n";
+        return 1;
+    }
+    if (!trie.find("application", value) || value != 3 || !trie.find("apply", value) || value != 5) {
+        std::cerr << "The inserted keys were not found.\n";
+        return 1;
+    }
+    if (trie.find("apple", value) || trie.find("banana", value) || trie.size() != 3) {
+        std::cerr << "The removed keys are still present.\n";
+        return 1;
+    }
+
+    // The resulting tree matches the one built by single operations.
+    ctrie::CTrie<int> expected;
+    expected.insert("app", 6);
+    expected.insert("application", 3);
+    expected.insert("apply", 5);
+    if (trie.toString() != expected.toString() || trie.stats().nodes != expected.stats().nodes) {
+        std::cerr << "The batch produced a different tree:\n" << trie << "\n";
+        return 1;
+    }
+
+    // A removal pruning nodes, followed by an insertion below them.
+    batch.clear();
+    batch.remove("application");
+    batch.insert("applications", 7);
+    batch.remove("app");
+    batch.insert("app", 8);
+    trie.apply(batch);
+    if (trie.find("application", value) || !trie.find("applications", value) || value != 7 ||
+        !trie.find("app", value) || value != 8 || trie.size() != 3) {
+        std::cerr << "Removals and insertions on shared prefixes were not applied.\n";
+        return 1;
+    }
+
+    // A batch with a key out of bounds leaves the trie untouched.
+    batch.clear();
+    batch.insert("valid", 9);
+    batch.insert(std::string(1, static_cast<char>(-1)), 10);
+    try {
+        trie.apply(batch);
+        std::cerr << "Expected an exception for a key out of bounds.\n";
+        return 1;
+    } catch (const std::out_of_range &) {
+        // Expected.
+    }
+    if (trie.find("valid", value)) {
+        std::cerr << "A rejected batch must not be applied.\n";
+        return 1;
+    }
+
+    // Readers see all of a batch or none of it.
+    ctrie::CTrie<int> pairs;
+    std::atomic<bool> done(false);
+    std::atomic<bool> torn(false);
+    std::thread reader([&] {
+        while (!done) {
+            // The statistics are collected under a single lock acquisition.
+            if (pairs.stats().keys % 2 != 0) {
+                torn = true;
+            }
+        }
+    });
+    for (int i = 0; i < 2000; ++i) {
+        ctrie::WriteBatch<int> step;
+        if (i % 2 == 0) {
+            step.insert("pair/a", i);
+            step.insert("pair/b", i);
+        } else {
+            step.remove("pair/a");
+            step.remove("pair/b");
+        }
+        pairs.apply(step);
+    }
+    done = true;
+    reader.join();
+    if (torn) {
+        std::cerr << "A reader observed a partially applied batch.\n";
+        return 1;
+    }
+    return 0;
+}